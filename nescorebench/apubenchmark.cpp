@@ -0,0 +1,84 @@
+#include "benchmark.h"
+
+// system includes
+#include <array>
+#include <utility>
+
+// nescorelib includes
+#include "nesemulator.h"
+#include "emusettings.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+const quint64 cyclesPerFrame = qRound(EmuSettings::cpuClockRate / EmuSettings::emuTimeTargetFps);
+
+// Every Apu::clock() also hands the mixer output to the band limited synthesis, flush()
+// filters the samples of the frame and they get pulled out like the frontends do
+quint64 clockApu(quint64 iterations, qint32 sampleRate, bool audioEnabled = true)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(0));
+    emulator.apu().setSampleRate(sampleRate);
+    emulator.apu().setAudioEnabled(audioEnabled);
+
+    // all channels playing something
+    static constexpr std::array<std::pair<quint16, quint8>, 13> registers {{
+        { 0x4015, 0x0F },
+        { 0x4000, 0xBF }, { 0x4002, 0xFD }, { 0x4003, 0x08 },
+        { 0x4004, 0x7F }, { 0x4006, 0x7E }, { 0x4007, 0x09 },
+        { 0x4008, 0xFF }, { 0x400A, 0x80 }, { 0x400B, 0x08 },
+        { 0x400C, 0x3F }, { 0x400E, 0x05 }, { 0x400F, 0x08 }
+    }};
+    // the apu takes over one register write per even clock
+    for(const auto &reg : registers)
+    {
+        emulator.memory().write(reg.first, reg.second);
+        emulator.apu().clock();
+        emulator.apu().clock();
+    }
+
+    std::array<qint32, 1024> samples;
+
+    for(quint64 i = 0; i < iterations; i++)
+    {
+        emulator.apu().clock();
+
+        if(i % cyclesPerFrame == cyclesPerFrame - 1)
+        {
+            emulator.apu().flush();
+            while(emulator.apu().readSamples(samples.data(), samples.size()));
+            doNotOptimize(samples);
+        }
+    }
+
+    return iterations;
+}
+
+quint64 runFrames(bool audioEnabled, quint64 frames)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(0));
+    emulator.apu().setAudioEnabled(audioEnabled);
+
+    for(quint64 i = 0; i < frames; i++)
+        emulator.emuClockFrame();
+
+    return frames;
+}
+}
+
+NESCORE_BENCHMARK(apuClock, "cycles") { return clockApu(iterations, 44100); }
+
+// whole frames at the supported output rates
+NESCORE_BENCHMARK(apuFrame22050, "frames") { return clockApu(iterations * cyclesPerFrame, 22050) / cyclesPerFrame; }
+NESCORE_BENCHMARK(apuFrame44100, "frames") { return clockApu(iterations * cyclesPerFrame, 44100) / cyclesPerFrame; }
+NESCORE_BENCHMARK(apuFrame48000, "frames") { return clockApu(iterations * cyclesPerFrame, 48000) / cyclesPerFrame; }
+NESCORE_BENCHMARK(apuFrame96000, "frames") { return clockApu(iterations * cyclesPerFrame, 96000) / cyclesPerFrame; }
+
+// the apu keeping only its cpu visible timing, like headless runs nobody listens to
+NESCORE_BENCHMARK(apuClockAudioOff, "cycles") { return clockApu(iterations, 44100, false); }
+NESCORE_BENCHMARK(apuFrameAudioOff, "frames") { return clockApu(iterations * cyclesPerFrame, 44100, false) / cyclesPerFrame; }
+NESCORE_BENCHMARK(framesNromAudio, "frames") { return runFrames(true, iterations); }
+NESCORE_BENCHMARK(framesNromAudioOff, "frames") { return runFrames(false, iterations); }
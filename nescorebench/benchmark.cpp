@@ -0,0 +1,34 @@
+#include "benchmark.h"
+
+Benchmark::Benchmark(const char *name, const char *unit, Function function) :
+    m_name(name), m_unit(unit), m_function(function)
+{
+    registry().push_back(this);
+}
+
+const char *Benchmark::name() const
+{
+    return m_name;
+}
+
+const char *Benchmark::unit() const
+{
+    return m_unit;
+}
+
+quint64 Benchmark::run(quint64 iterations) const
+{
+    return m_function(iterations);
+}
+
+const std::vector<const Benchmark*> &Benchmark::all()
+{
+    return registry();
+}
+
+std::vector<const Benchmark*> &Benchmark::registry()
+{
+    // function local so that registering from other translation units works regardless of init order
+    static std::vector<const Benchmark*> benchmarks;
+    return benchmarks;
+}
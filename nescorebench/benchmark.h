@@ -0,0 +1,47 @@
+#pragma once
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <vector>
+
+class Benchmark
+{
+public:
+    // Runs the measured code iterations times and returns the number of processed items
+    using Function = quint64 (*)(quint64 iterations);
+
+    Benchmark(const char *name, const char *unit, Function function);
+
+    const char *name() const;
+    const char *unit() const;
+    quint64 run(quint64 iterations) const;
+
+    static const std::vector<const Benchmark*> &all();
+
+private:
+    static std::vector<const Benchmark*> &registry();
+
+    const char *m_name;
+    const char *m_unit;
+    Function m_function;
+};
+
+// Keeps the compiler from dropping the computation of value
+template<typename T>
+void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void *sink;
+    sink = &value;
+#endif
+}
+
+// Defines a benchmark function and registers it, the body sees quint64 iterations.
+#define NESCORE_BENCHMARK(identifier, unit) \
+    static quint64 identifier(quint64 iterations); \
+    static const Benchmark identifier##Benchmark(#identifier, unit, &identifier); \
+    static quint64 identifier(quint64 iterations)
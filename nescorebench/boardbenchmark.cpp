@@ -0,0 +1,77 @@
+#include "benchmark.h"
+
+// nescorelib includes
+#include "nesemulator.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+quint64 runFrames(int mapperNumber, bool boardHookMask, quint64 frames)
+{
+    NesEmulator emulator;
+    emulator.memory().setBoardHookMaskEnabled(boardHookMask);
+    emulator.load(makeSyntheticRom(mapperNumber));
+
+    for(quint64 i = 0; i < frames; i++)
+        emulator.emuClockFrame();
+
+    return frames;
+}
+
+// Board reads on their own, like the cpu fetching from $8000-$FFFF and the ppu from the
+// pattern tables
+quint64 readPrg(int mapperNumber, quint64 iterations)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(mapperNumber));
+    auto &board = *emulator.memory().board();
+
+    quint8 sum {};
+    for(quint64 i = 0; i < iterations; i++)
+        for(quint32 address = 0x8000; address <= 0xFFFF; address++)
+            sum += board.readPrg(quint16(address));
+    doNotOptimize(sum);
+
+    return iterations * 0x8000;
+}
+
+quint64 readChr(int mapperNumber, quint64 iterations)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(mapperNumber));
+    auto &board = *emulator.memory().board();
+
+    quint8 sum {};
+    for(quint64 i = 0; i < iterations; i++)
+        for(quint16 address = 0x0000; address < 0x2000; address++)
+            sum += board.readChr(address);
+    doNotOptimize(sum);
+
+    return iterations * 0x2000;
+}
+}
+
+// Every board callback called on every clock, like before the hook mask existed
+NESCORE_BENCHMARK(framesNromAllHooks, "frames") { return runFrames(0, false, iterations); }
+NESCORE_BENCHMARK(framesUxromAllHooks, "frames") { return runFrames(2, false, iterations); }
+NESCORE_BENCHMARK(framesMmc1AllHooks, "frames") { return runFrames(1, false, iterations); }
+NESCORE_BENCHMARK(framesMmc3AllHooks, "frames") { return runFrames(4, false, iterations); }
+
+// Only the callbacks the board implements
+NESCORE_BENCHMARK(framesNrom, "frames") { return runFrames(0, true, iterations); }
+NESCORE_BENCHMARK(framesUxrom, "frames") { return runFrames(2, true, iterations); }
+NESCORE_BENCHMARK(framesMmc1, "frames") { return runFrames(1, true, iterations); }
+NESCORE_BENCHMARK(framesMmc3, "frames") { return runFrames(4, true, iterations); }
+
+// One iteration reads the whole prg window or pattern table area
+NESCORE_BENCHMARK(boardReadPrgNrom, "reads") { return readPrg(0, iterations); }
+NESCORE_BENCHMARK(boardReadPrgMmc1, "reads") { return readPrg(1, iterations); }
+NESCORE_BENCHMARK(boardReadPrgUxrom, "reads") { return readPrg(2, iterations); }
+NESCORE_BENCHMARK(boardReadPrgCnrom, "reads") { return readPrg(3, iterations); }
+NESCORE_BENCHMARK(boardReadPrgMmc3, "reads") { return readPrg(4, iterations); }
+NESCORE_BENCHMARK(boardReadChrNrom, "reads") { return readChr(0, iterations); }
+NESCORE_BENCHMARK(boardReadChrMmc1, "reads") { return readChr(1, iterations); }
+NESCORE_BENCHMARK(boardReadChrUxrom, "reads") { return readChr(2, iterations); }
+NESCORE_BENCHMARK(boardReadChrCnrom, "reads") { return readChr(3, iterations); }
+NESCORE_BENCHMARK(boardReadChrMmc3, "reads") { return readChr(4, iterations); }
@@ -0,0 +1,94 @@
+#include "benchmark.h"
+
+// system includes
+#include <vector>
+
+// nescorelib includes
+#include "nesemulator.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+// Rendering stays off, so the ppu clocks mostly get deferred and the cpu dominates
+quint64 runInstructions(const std::vector<quint8> &program, Cpu::Dispatch dispatch, quint64 instructions, bool decodeCache = false)
+{
+    NesEmulator emulator;
+    emulator.load(makeProgramRom(0, program));
+    emulator.cpu().setDispatch(dispatch);
+    emulator.cpu().setDecodeCacheEnabled(decodeCache);
+
+    const auto cycles = emulator.cycles();
+    for(quint64 i = 0; i < instructions; i++)
+        emulator.cpu().clock();
+
+    return emulator.cycles() - cycles;
+}
+
+const std::vector<quint8> aluProgram {
+    0xA9, 0x01,         // F000 LDA #$01
+    0x18,               // F002 CLC
+    0x69, 0x03,         // F003 ADC #$03
+    0x49, 0x5A,         // F005 EOR #$5A
+    0x0A,               // F007 ASL A
+    0x6A,               // F008 ROR A
+    0x29, 0x7F,         // F009 AND #$7F
+    0x09, 0x11,         // F00B ORA #$11
+    0xAA,               // F00D TAX
+    0xE8,               // F00E INX
+    0x8A,               // F00F TXA
+    0xA8,               // F010 TAY
+    0x88,               // F011 DEY
+    0x98,               // F012 TYA
+    0x38,               // F013 SEC
+    0xE9, 0x01,         // F014 SBC #$01
+    0x4C, 0x02, 0xF0    // F016 JMP $F002
+};
+
+const std::vector<quint8> loadStoreProgram {
+    0xA2, 0x00,         // F000 LDX #$00
+    0xB5, 0x10,         // F002 LDA $10,X
+    0x9D, 0x00, 0x04,   // F004 STA $0400,X
+    0xBC, 0x00, 0x02,   // F007 LDY $0200,X
+    0x84, 0x20,         // F00A STY $20
+    0xB1, 0x30,         // F00C LDA ($30),Y
+    0x99, 0x00, 0x05,   // F00E STA $0500,Y
+    0xE8,               // F011 INX
+    0xD0, 0xEE,         // F012 BNE $F002
+    0x4C, 0x00, 0xF0    // F014 JMP $F000
+};
+
+const std::vector<quint8> readModifyWriteProgram {
+    0xA2, 0x00,         // F000 LDX #$00
+    0xFE, 0x00, 0x03,   // F002 INC $0300,X
+    0x16, 0x40,         // F005 ASL $40,X
+    0x7E, 0x00, 0x04,   // F007 ROR $0400,X
+    0xE8,               // F00A INX
+    0xD0, 0xF5,         // F00B BNE $F002
+    0x4C, 0x00, 0xF0    // F00D JMP $F000
+};
+
+const std::vector<quint8> branchProgram {
+    0xA2, 0x08,         // F000 LDX #$08
+    0xCA,               // F002 DEX
+    0xD0, 0xFD,         // F003 BNE $F002
+    0x20, 0x0B, 0xF0,   // F005 JSR $F00B
+    0x4C, 0x00, 0xF0,   // F008 JMP $F000
+    0x60                // F00B RTS
+};
+}
+
+// Cpu::clock() runs one instruction, the cycles/s include the bus accesses of every cycle
+NESCORE_BENCHMARK(cpuAlu, "cycles") { return runInstructions(aluProgram, Cpu::Dispatch::Fused, iterations); }
+NESCORE_BENCHMARK(cpuAluTable, "cycles") { return runInstructions(aluProgram, Cpu::Dispatch::Table, iterations); }
+NESCORE_BENCHMARK(cpuLoadStore, "cycles") { return runInstructions(loadStoreProgram, Cpu::Dispatch::Fused, iterations); }
+NESCORE_BENCHMARK(cpuLoadStoreTable, "cycles") { return runInstructions(loadStoreProgram, Cpu::Dispatch::Table, iterations); }
+NESCORE_BENCHMARK(cpuReadModifyWrite, "cycles") { return runInstructions(readModifyWriteProgram, Cpu::Dispatch::Fused, iterations); }
+NESCORE_BENCHMARK(cpuReadModifyWriteTable, "cycles") { return runInstructions(readModifyWriteProgram, Cpu::Dispatch::Table, iterations); }
+NESCORE_BENCHMARK(cpuBranches, "cycles") { return runInstructions(branchProgram, Cpu::Dispatch::Fused, iterations); }
+NESCORE_BENCHMARK(cpuBranchesTable, "cycles") { return runInstructions(branchProgram, Cpu::Dispatch::Table, iterations); }
+
+// Same with the decoded opcode cache
+NESCORE_BENCHMARK(cpuAluDecodeCache, "cycles") { return runInstructions(aluProgram, Cpu::Dispatch::Fused, iterations, true); }
+NESCORE_BENCHMARK(cpuLoadStoreDecodeCache, "cycles") { return runInstructions(loadStoreProgram, Cpu::Dispatch::Fused, iterations, true); }
+NESCORE_BENCHMARK(cpuBranchesDecodeCache, "cycles") { return runInstructions(branchProgram, Cpu::Dispatch::Fused, iterations, true); }
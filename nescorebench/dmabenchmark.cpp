@@ -0,0 +1,32 @@
+#include "benchmark.h"
+
+// nescorelib includes
+#include "nesemulator.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+// Every write to $4014 makes the next read cycle run Dma::clock() through the whole
+// transfer of 256 bytes into oam, with all components clocked in between
+quint64 oamDmas(bool rendering, quint64 transfers)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(0));
+    emulator.emuClockFrame();
+    if(!rendering)
+        emulator.memory().write(0x2001, 0x00);
+
+    const auto cycles = emulator.cycles();
+    for(quint64 i = 0; i < transfers; i++)
+    {
+        emulator.memory().write(0x4014, 0x02);
+        emulator.memory().read(0x0000);
+    }
+
+    return emulator.cycles() - cycles;
+}
+}
+
+NESCORE_BENCHMARK(dmaOamRendering, "cycles") { return oamDmas(true, iterations); }
+NESCORE_BENCHMARK(dmaOamBlank, "cycles") { return oamDmas(false, iterations); }
@@ -0,0 +1,155 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+
+// system includes
+#include <algorithm>
+#include <vector>
+
+// local includes
+#include "benchmark.h"
+
+// nescorelib includes
+#include "emu/ppukernels.h"
+
+namespace {
+struct Result {
+    const Benchmark *benchmark;
+    quint64 iterations;
+    quint64 items;
+    qint64 elapsed; // ns
+};
+
+// Same layout as google benchmark's --benchmark_format=json, so the usual tooling can chart it
+void writeJson(QTextStream &stream, const std::vector<Result> &results, qint64 minTime)
+{
+    stream << "{\n"
+           << "  \"context\": {\n"
+           << "    \"executable\": \"nescore_bench\",\n"
+           << "    \"ppu_kernels\": \"" << PpuKernels::instructionSet() << "\",\n"
+           << "    \"min_time_ms\": " << (minTime / 1000000) << "\n"
+           << "  },\n"
+           << "  \"benchmarks\": [";
+
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        const auto &result = results[i];
+        const auto seconds = result.elapsed / 1000000000.;
+        const auto time = QString::number(result.elapsed / double(result.iterations), 'f', 3);
+        // every benchmark is its own family with one run on one thread, cpu_time repeats
+        // the wall clock time
+        stream << (i ? ",\n" : "\n")
+               << "    {\n"
+               << "      \"name\": \"" << result.benchmark->name() << "\",\n"
+               << "      \"family_index\": " << i << ",\n"
+               << "      \"per_family_instance_index\": 0,\n"
+               << "      \"run_name\": \"" << result.benchmark->name() << "\",\n"
+               << "      \"run_type\": \"iteration\",\n"
+               << "      \"repetitions\": 1,\n"
+               << "      \"repetition_index\": 0,\n"
+               << "      \"threads\": 1,\n"
+               << "      \"iterations\": " << result.iterations << ",\n"
+               << "      \"real_time\": " << time << ",\n"
+               << "      \"cpu_time\": " << time << ",\n"
+               << "      \"time_unit\": \"ns\",\n"
+               << "      \"items_per_second\": " << QString::number(result.items / seconds, 'f', 3) << ",\n"
+               << "      \"unit\": \"" << result.benchmark->unit() << "\"\n"
+               << "    }";
+    }
+
+    stream << "\n  ]\n}\n";
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("nescore_bench"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Micro benchmarks for the nescorelib components."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("filter"), QStringLiteral("Only run benchmarks whose name contains one of these."));
+
+    const QCommandLineOption minTimeOption(QStringLiteral("min-time"),
+                                           QStringLiteral("Minimum run time of every benchmark in milliseconds (default 500)."),
+                                           QStringLiteral("ms"), QStringLiteral("500"));
+    const QCommandLineOption jsonOption(QStringLiteral("json"),
+                                        QStringLiteral("Also write the results as json to this file."),
+                                        QStringLiteral("file"));
+    parser.addOption(minTimeOption);
+    parser.addOption(jsonOption);
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    bool ok;
+    const auto minTime = parser.value(minTimeOption).toLongLong(&ok) * 1000000;
+    if(!ok)
+    {
+        err << "invalid minimum time " << parser.value(minTimeOption) << endl;
+        return 1;
+    }
+
+    out << "ppu kernels: " << PpuKernels::instructionSet() << endl;
+
+    const auto filters = parser.positionalArguments();
+
+    std::vector<Result> results;
+
+    for(const auto *benchmark : Benchmark::all())
+    {
+        if(!filters.isEmpty())
+        {
+            const auto name = QString::fromLatin1(benchmark->name());
+            if(std::none_of(filters.cbegin(), filters.cend(), [&name](const QString &filter){ return name.contains(filter); }))
+                continue;
+        }
+
+        // warm up once, then double the iterations until the run takes long enough
+        benchmark->run(1);
+
+        quint64 iterations = 1;
+        quint64 items;
+        qint64 elapsed;
+        forever
+        {
+            QElapsedTimer timer;
+            timer.start();
+            items = benchmark->run(iterations);
+            elapsed = timer.nsecsElapsed();
+
+            if(elapsed >= minTime)
+                break;
+
+            iterations *= 2;
+        }
+
+        const auto seconds = elapsed / 1000000000.;
+        out << benchmark->name() << ": "
+            << iterations << " iterations, "
+            << (elapsed / double(iterations)) << " ns/iteration, "
+            << (items / seconds) << ' ' << benchmark->unit() << "/s" << endl;
+
+        results.push_back({ benchmark, iterations, items, elapsed });
+    }
+
+    if(parser.isSet(jsonOption))
+    {
+        QFile file(parser.value(jsonOption));
+        if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            err << "cannot open file " << file.fileName() << " because " << file.errorString() << endl;
+            return 1;
+        }
+
+        QTextStream stream(&file);
+        writeJson(stream, results, minTime);
+    }
+
+    return 0;
+}
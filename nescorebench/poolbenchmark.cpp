@@ -0,0 +1,31 @@
+#include "benchmark.h"
+
+// nescorelib includes
+#include "emulatorpool.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+// Enough instances to keep 16 threads busy, mixing boards with and without ppu catch up
+quint64 runPool(int threadCount, quint64 frames)
+{
+    static constexpr std::array<int, 4> mappers { 0, 1, 2, 4 };
+    constexpr std::size_t instances = 32;
+
+    EmulatorPool pool(threadCount);
+    for(std::size_t i = 0; i < instances; i++)
+        pool.addInstance(makeSyntheticRom(mappers[i % mappers.size()]));
+
+    pool.runFrames(frames);
+
+    return frames * instances;
+}
+}
+
+// Aggregate frames/s over all instances
+NESCORE_BENCHMARK(poolThreads1, "frames") { return runPool(1, iterations); }
+NESCORE_BENCHMARK(poolThreads2, "frames") { return runPool(2, iterations); }
+NESCORE_BENCHMARK(poolThreads4, "frames") { return runPool(4, iterations); }
+NESCORE_BENCHMARK(poolThreads8, "frames") { return runPool(8, iterations); }
+NESCORE_BENCHMARK(poolThreads16, "frames") { return runPool(16, iterations); }
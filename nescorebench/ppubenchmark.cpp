@@ -0,0 +1,33 @@
+#include "benchmark.h"
+
+// nescorelib includes
+#include "nesemulator.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+constexpr quint64 clocksPerFrame = 341 * 262;
+
+// Clocks the ppu on its own, without the cpu or the scanline fast path
+quint64 clockFrames(bool rendering, quint64 frames)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(0));
+
+    // the rom turns rendering on right after reset
+    emulator.emuClockFrame();
+    emulator.emuClockFrame();
+    if(!rendering)
+        emulator.memory().write(0x2001, 0x00);
+    emulator.ppuCatchUp();
+
+    for(quint64 i = 0; i < frames * clocksPerFrame; i++)
+        emulator.ppu().clock();
+
+    return frames * clocksPerFrame;
+}
+}
+
+NESCORE_BENCHMARK(ppuFrameRendering, "cycles") { return clockFrames(true, iterations); }
+NESCORE_BENCHMARK(ppuFrameBlank, "cycles") { return clockFrames(false, iterations); }
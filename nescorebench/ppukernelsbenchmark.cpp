@@ -0,0 +1,86 @@
+#include "benchmark.h"
+
+// system includes
+#include <array>
+
+// nescorelib includes
+#include "emu/ppukernels.h"
+#include "emu/ppu.h"
+#include "emusettings.h"
+
+NESCORE_BENCHMARK(ppuKernelsDecodeLookup, "pixels")
+{
+    constexpr auto tiles = Ppu::SCREEN_WIDTH / 8;
+
+    // some made up pattern data that covers all colors and attributes
+    std::array<quint8, tiles> low;
+    std::array<quint8, tiles> high;
+    std::array<quint8, tiles> attributes;
+    for(std::size_t i = 0; i < tiles; i++)
+    {
+        low[i] = quint8(i * 37 + 11);
+        high[i] = quint8(i * 91 + 5);
+        attributes[i] = (i << 2) & 0xC;
+    }
+
+    std::array<quint8, 32> paletteBank;
+    for(std::size_t i = 0; i < paletteBank.size(); i++)
+        paletteBank[i] = quint8(i * 7);
+
+    std::array<qint32, 32> lut;
+    PpuKernels::buildPaletteLut(paletteBank, 0x3F, lut);
+
+    std::array<quint8, Ppu::SCREEN_WIDTH> pixels;
+    std::array<qint32, Ppu::SCREEN_WIDTH> colors;
+
+    for(quint64 i = 0; i < iterations; i++)
+    {
+        low[0] = quint8(i);
+        PpuKernels::decodeTileRows(low.data(), high.data(), attributes.data(), tiles, pixels.data());
+        PpuKernels::lookupPalette(pixels.data(), Ppu::SCREEN_WIDTH, lut, colors.data());
+        doNotOptimize(colors);
+    }
+
+    return iterations * Ppu::SCREEN_WIDTH;
+}
+
+NESCORE_BENCHMARK(ppuKernelsDecodeLookupScalar, "pixels")
+{
+    // the per pixel loops the ppu used before the kernels, as reference
+    constexpr auto tiles = Ppu::SCREEN_WIDTH / 8;
+
+    std::array<quint8, 32> paletteBank;
+    for(std::size_t i = 0; i < paletteBank.size(); i++)
+        paletteBank[i] = quint8(i * 7);
+
+    std::array<quint8, Ppu::SCREEN_WIDTH> pixels;
+    std::array<qint32, Ppu::SCREEN_WIDTH> colors;
+
+    for(quint64 i = 0; i < iterations; i++)
+    {
+        for(std::size_t tile = 0; tile < tiles; tile++)
+        {
+            quint8 low = tile == 0 ? quint8(i) : quint8(tile * 37 + 11);
+            quint8 high = quint8(tile * 91 + 5);
+            const quint8 attribute = (tile << 2) & 0xC;
+
+            for(auto x = 0; x < 8; x++)
+            {
+                const auto temp = attribute | (low >> 7 & 1) | (high >> 6 & 2);
+                pixels[tile * 8 + x] = (temp & 3) != 0 ? temp : 0;
+                low <<= 1;
+                high <<= 1;
+            }
+        }
+
+        for(std::size_t x = 0; x < pixels.size(); x++)
+        {
+            const auto index = (pixels[x] & 3) ? pixels[x] : (pixels[x] & 0x0C);
+            colors[x] = EmuSettings::Video::palette[paletteBank[index] & 0x3F];
+        }
+
+        doNotOptimize(colors);
+    }
+
+    return iterations * Ppu::SCREEN_WIDTH;
+}
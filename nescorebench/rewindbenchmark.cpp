@@ -0,0 +1,52 @@
+#include "benchmark.h"
+
+// nescorelib includes
+#include "nesemulator.h"
+#include "rewindbuffer.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+quint64 runFrames(int mapperNumber, quint64 frames)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(mapperNumber));
+    RewindBuffer rewind(emulator);
+
+    for(quint64 i = 0; i < frames; i++)
+    {
+        emulator.emuClockFrame();
+        rewind.frameFinished();
+    }
+
+    return frames;
+}
+
+quint64 captureAndStepBack(int mapperNumber, quint64 iterations)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(mapperNumber));
+    emulator.emuClockFrame();
+
+    RewindBuffer rewind(emulator);
+
+    // stepBack() skips the snapshot of the current state and loads the one before
+    for(quint64 i = 0; i < iterations; i++)
+    {
+        rewind.capture();
+        rewind.capture();
+        rewind.stepBack();
+    }
+
+    return iterations;
+}
+}
+
+// Compare with framesNrom/framesMmc3 for the per frame overhead of capturing
+NESCORE_BENCHMARK(rewindFramesNrom, "frames") { return runFrames(0, iterations); }
+NESCORE_BENCHMARK(rewindFramesMmc3, "frames") { return runFrames(4, iterations); }
+
+// Two captures plus one step back that loads the older one, without the emulation in between
+NESCORE_BENCHMARK(rewindCycleNrom, "snapshots") { return captureAndStepBack(0, iterations); }
+NESCORE_BENCHMARK(rewindCycleMmc3, "snapshots") { return captureAndStepBack(4, iterations); }
@@ -0,0 +1,27 @@
+#include "benchmark.h"
+
+// nescorelib includes
+#include "nesemulator.h"
+#include "runahead.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+quint64 runFrames(int mapperNumber, int runAheadFrames, quint64 frames)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(mapperNumber));
+    RunAhead runAhead(emulator, runAheadFrames);
+
+    for(quint64 i = 0; i < frames; i++)
+        runAhead.emuClockFrame();
+
+    return frames;
+}
+}
+
+// Presented frames/s, every frame ahead costs roughly one more emulated frame
+NESCORE_BENCHMARK(runAhead0Mmc3, "frames") { return runFrames(4, 0, iterations); }
+NESCORE_BENCHMARK(runAhead1Mmc3, "frames") { return runFrames(4, 1, iterations); }
+NESCORE_BENCHMARK(runAhead2Mmc3, "frames") { return runFrames(4, 2, iterations); }
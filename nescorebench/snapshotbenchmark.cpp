@@ -0,0 +1,47 @@
+#include "benchmark.h"
+
+// system includes
+#include <vector>
+
+// nescorelib includes
+#include "nesemulator.h"
+
+// local includes
+#include "syntheticrom.h"
+
+namespace {
+quint64 saveStates(int mapperNumber, quint64 iterations)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(mapperNumber));
+    emulator.emuClockFrame();
+
+    std::vector<quint8> state(emulator.stateSize());
+    for(quint64 i = 0; i < iterations; i++)
+        emulator.saveState(state.data(), state.size());
+
+    return iterations;
+}
+
+quint64 loadStates(int mapperNumber, quint64 iterations)
+{
+    NesEmulator emulator;
+    emulator.load(makeSyntheticRom(mapperNumber));
+    emulator.emuClockFrame();
+
+    std::vector<quint8> state(emulator.stateSize());
+    emulator.saveState(state.data(), state.size());
+    for(quint64 i = 0; i < iterations; i++)
+        emulator.loadState(state.data(), state.size());
+
+    return iterations;
+}
+}
+
+// One snapshot per frame is taken for rewind, ns/iteration is the cost of one save or load
+NESCORE_BENCHMARK(snapshotSaveNrom, "snapshots") { return saveStates(0, iterations); }
+NESCORE_BENCHMARK(snapshotSaveMmc1, "snapshots") { return saveStates(1, iterations); }
+NESCORE_BENCHMARK(snapshotSaveMmc3, "snapshots") { return saveStates(4, iterations); }
+NESCORE_BENCHMARK(snapshotLoadNrom, "snapshots") { return loadStates(0, iterations); }
+NESCORE_BENCHMARK(snapshotLoadMmc1, "snapshots") { return loadStates(1, iterations); }
+NESCORE_BENCHMARK(snapshotLoadMmc3, "snapshots") { return loadStates(4, iterations); }
@@ -0,0 +1,64 @@
+#include "syntheticrom.h"
+
+// system includes
+#include <algorithm>
+
+Rom makeSyntheticRom(int mapperNumber)
+{
+    return makeProgramRom(mapperNumber, {
+        0x78,               // F000 SEI
+        0xD8,               // F001 CLD
+        0xA9, 0x80,         // F002 LDA #$80
+        0x8D, 0x00, 0x20,   // F004 STA $2000
+        0xA9, 0x1E,         // F007 LDA #$1E
+        0x8D, 0x01, 0x20,   // F009 STA $2001
+        0xA2, 0x00,         // F00C LDX #$00
+        0xBD, 0x00, 0x03,   // F00E LDA $0300,X
+        0x69, 0x01,         // F011 ADC #$01
+        0x9D, 0x00, 0x03,   // F013 STA $0300,X
+        0xE8,               // F016 INX
+        0xD0, 0xF5,         // F017 BNE $F00E
+        0x4C, 0x0C, 0xF0    // F019 JMP $F00C
+    });
+}
+
+Rom makeProgramRom(int mapperNumber, const std::vector<quint8> &program)
+{
+    std::array<quint8, 0x1000> prgPage {};
+    Q_ASSERT(program.size() < 0xFFA);
+    std::copy(std::begin(program), std::end(program), std::begin(prgPage));
+
+    const auto rti = quint16(0xF000 + program.size());
+    prgPage[program.size()] = 0x40; // RTI
+
+    // nmi, reset and irq vectors
+    prgPage[0xFFA] = quint8(rti);
+    prgPage[0xFFB] = quint8(rti >> 8);
+    prgPage[0xFFC] = 0x00;
+    prgPage[0xFFD] = 0xF0;
+    prgPage[0xFFE] = quint8(rti);
+    prgPage[0xFFF] = quint8(rti >> 8);
+
+    std::array<quint8, 0x400> chrPage;
+    for(std::size_t i = 0; i < chrPage.size(); i++)
+        chrPage[i] = quint8(i * 13);
+
+    Rom rom;
+    rom.prgCount = 8; // 16kb units
+    rom.chrCount = 1; // 8kb units
+    rom.mirroring = Mirroring::Vertical;
+    rom.hasBattery = false;
+    rom.hasTrainer = false;
+    rom.mapperNumber = mapperNumber;
+    rom.isVsUnisystem = false;
+    rom.isPlaychoice10 = false;
+
+    for(auto i = 0; i < rom.prgCount * 4; i++)
+        rom.prg.append(prgPage);
+    for(auto i = 0; i < rom.chrCount * 8; i++)
+        rom.chr.append(chrPage);
+
+    rom.trainer.fill(0);
+
+    return rom;
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+// system includes
+#include <vector>
+
+// nescorelib includes
+#include "rom.h"
+
+// Builds a small rom for the given mapper that turns on rendering and then keeps the cpu
+// busy with a read-modify-write loop over zero page. Every 4kb prg page holds the same
+// code, so it runs no matter how the board maps its banks.
+Rom makeSyntheticRom(int mapperNumber);
+
+// Same layout, but with the given program at $F000 (reset vector) and an RTI for the
+// interrupts behind it
+Rom makeProgramRom(int mapperNumber, const std::vector<quint8> &program);
@@ -0,0 +1,240 @@
+#include "avrecorder.h"
+
+// Qt includes
+#include <QDataStream>
+#include <QSysInfo>
+
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+// local includes
+#include "emusettings.h"
+
+namespace {
+constexpr quint32 waveHeaderSize = 44;
+
+// the writer sleeps this long when the queue is empty, a frame takes 16ms
+constexpr std::chrono::milliseconds idleSleep(2);
+}
+
+AvRecorder::AvRecorder(const QString &videoPath, const QString &audioPath, qint32 sampleRate, std::size_t queueFrames) :
+    m_videoFile(videoPath),
+    m_audioFile(audioPath),
+    m_sampleRate(sampleRate),
+    m_maxPacketSamples(std::max(sampleRate / 10, 1)),
+    m_queue(std::max<std::size_t>(queueFrames, 1), Packet { {}, std::vector<qint32>(m_maxPacketSamples), 0, 0 })
+{
+    if(!videoPath.isEmpty() && !m_videoFile.open(QIODevice::WriteOnly))
+        throw std::runtime_error(QString("cannot open file %0 because %1").arg(videoPath, m_videoFile.errorString()).toStdString());
+    if(!audioPath.isEmpty() && !m_audioFile.open(QIODevice::WriteOnly))
+        throw std::runtime_error(QString("cannot open file %0 because %1").arg(audioPath, m_audioFile.errorString()).toStdString());
+
+    // everything the emulation thread touches gets allocated here
+    m_pendingSamples.reserve(m_maxPacketSamples);
+    m_videoBuffer.resize(6 + 3 * std::tuple_size<Frame>::value);
+
+    writeHeaders();
+
+    m_thread = std::thread(&AvRecorder::run, this);
+}
+
+AvRecorder::~AvRecorder()
+{
+    finish();
+}
+
+void AvRecorder::addSamples(const qint32 *samples, std::size_t count)
+{
+    const auto fitting = std::min(count, m_maxPacketSamples - m_pendingSamples.size());
+    m_pendingSamples.insert(m_pendingSamples.end(), samples, samples + fitting);
+    m_droppedSamples += count - fitting;
+}
+
+void AvRecorder::addFrame(const Frame &frame)
+{
+    m_frames++;
+
+    auto *packet = m_queue.writeSlot();
+    if(!packet)
+    {
+        // the samples stay pending for the next packet, the frame gets repeated in its place
+        m_pendingDroppedFrames++;
+        m_droppedFrames++;
+        return;
+    }
+
+    packet->frame = frame;
+    std::copy(m_pendingSamples.cbegin(), m_pendingSamples.cend(), packet->samples.begin());
+    packet->sampleCount = m_pendingSamples.size();
+    packet->droppedFramesBefore = m_pendingDroppedFrames;
+    m_queue.push();
+
+    m_pendingSamples.clear();
+    m_pendingDroppedFrames = 0;
+}
+
+void AvRecorder::finish()
+{
+    if(m_finished)
+        return;
+    m_finished = true;
+
+    m_quit = true;
+    m_thread.join();
+
+    finishAudio();
+}
+
+quint64 AvRecorder::frames() const
+{
+    return m_frames;
+}
+
+quint64 AvRecorder::droppedFrames() const
+{
+    return m_droppedFrames;
+}
+
+quint64 AvRecorder::droppedSamples() const
+{
+    return m_droppedSamples;
+}
+
+std::size_t AvRecorder::queueCapacity() const
+{
+    return m_queue.capacity();
+}
+
+bool AvRecorder::writeFailed() const
+{
+    return m_writeFailed;
+}
+
+void AvRecorder::writeHeaders()
+{
+    if(m_videoFile.isOpen())
+    {
+        const auto header = QStringLiteral("YUV4MPEG2 W%0 H%1 F%2:1000 Ip A1:1 C444\n")
+                .arg(Ppu::SCREEN_WIDTH).arg(Ppu::SCREEN_HEIGHT)
+                .arg(qRound(EmuSettings::emuTimeTargetFps * 1000.)).toLatin1();
+        if(m_videoFile.write(header) != header.size())
+            m_writeFailed = true;
+    }
+
+    // the sizes get filled in by finishAudio()
+    if(m_audioFile.isOpen())
+    {
+        QDataStream dataStream(&m_audioFile);
+        dataStream.setByteOrder(QDataStream::LittleEndian);
+
+        dataStream << quint32(0x46464952) // "RIFF"
+                   << quint32(0)
+                   << quint32(0x45564157) // "WAVE"
+                   << quint32(0x20746D66) // "fmt "
+                   << quint32(16)
+                   << quint16(1) // pcm
+                   << quint16(1) // channels
+                   << quint32(m_sampleRate)
+                   << quint32(m_sampleRate * sizeof(qint32))
+                   << quint16(sizeof(qint32))
+                   << quint16(32)
+                   << quint32(0x61746164) // "data"
+                   << quint32(0);
+
+        if(dataStream.status() != QDataStream::Ok)
+            m_writeFailed = true;
+    }
+}
+
+void AvRecorder::writePacket(const Packet &packet)
+{
+    if(m_videoFile.isOpen())
+    {
+        for(quint32 i = 0; i < packet.droppedFramesBefore; i++)
+            writeVideoFrame(m_lastFrame);
+        writeVideoFrame(packet.frame);
+        m_lastFrame = packet.frame;
+    }
+
+    if(m_audioFile.isOpen() && packet.sampleCount)
+    {
+        const auto bytes = qint64(packet.sampleCount * sizeof(qint32));
+        if(m_audioFile.write(reinterpret_cast<const char *>(packet.samples.data()), bytes) != bytes)
+            m_writeFailed = true;
+        m_audioBytes += bytes;
+    }
+}
+
+void AvRecorder::writeVideoFrame(const Frame &frame)
+{
+    constexpr auto pixels = std::tuple_size<Frame>::value;
+
+    std::copy_n("FRAME\n", 6, m_videoBuffer.begin());
+    auto *y = &m_videoBuffer[6];
+    auto *u = y + pixels;
+    auto *v = u + pixels;
+
+    // bt.601 studio range
+    for(std::size_t i = 0; i < pixels; i++)
+    {
+        const auto r = (frame[i] >> 16) & 0xFF;
+        const auto g = (frame[i] >> 8) & 0xFF;
+        const auto b = frame[i] & 0xFF;
+        y[i] = quint8(16 + ((66 * r + 129 * g + 25 * b + 128) >> 8));
+        u[i] = quint8(128 + ((-38 * r - 74 * g + 112 * b + 128) >> 8));
+        v[i] = quint8(128 + ((112 * r - 94 * g - 18 * b + 128) >> 8));
+    }
+
+    const auto bytes = qint64(m_videoBuffer.size());
+    if(m_videoFile.write(reinterpret_cast<const char *>(m_videoBuffer.data()), bytes) != bytes)
+        m_writeFailed = true;
+}
+
+void AvRecorder::finishAudio()
+{
+    if(!m_audioFile.isOpen())
+        return;
+
+    // wave stores the sample data little endian
+    Q_ASSERT(QSysInfo::ByteOrder == QSysInfo::LittleEndian);
+
+    QDataStream dataStream(&m_audioFile);
+    dataStream.setByteOrder(QDataStream::LittleEndian);
+
+    m_audioFile.seek(4);
+    dataStream << quint32(waveHeaderSize - 8 + m_audioBytes);
+    m_audioFile.seek(waveHeaderSize - 4);
+    dataStream << quint32(m_audioBytes);
+
+    if(dataStream.status() != QDataStream::Ok || !m_audioFile.flush())
+        m_writeFailed = true;
+
+    m_audioFile.close();
+}
+
+void AvRecorder::run()
+{
+    forever
+    {
+        // checked before looking at the queue, so everything pushed before quitting gets written
+        const bool quit = m_quit;
+
+        if(const auto *packet = m_queue.readSlot())
+        {
+            writePacket(*packet);
+            m_queue.pop();
+            continue;
+        }
+
+        if(quit)
+            break;
+
+        std::this_thread::sleep_for(idleSleep);
+    }
+
+    if(m_videoFile.isOpen() && !m_videoFile.flush())
+        m_writeFailed = true;
+    m_videoFile.close();
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+#include <QFile>
+
+// system includes
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// local includes
+#include "emu/ppu.h"
+#include "spscring.h"
+
+// Records the frames as one raw YUV4MPEG2 (4:4:4) stream and the samples as 32 bit wave
+// file. The emulation thread only copies into a preallocated lock free queue, converting
+// and writing happens on a background thread. When the writer falls behind frames get
+// dropped instead of blocking the emulation, the writer repeats the previous frame in their
+// place so audio and video stay in sync.
+class NESCORELIB_EXPORT AvRecorder
+{
+    Q_DISABLE_COPY(AvRecorder)
+
+public:
+    using Frame = std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT>;
+
+    // An empty path skips that stream. Throws std::runtime_error when a file cannot be opened.
+    explicit AvRecorder(const QString &videoPath, const QString &audioPath, qint32 sampleRate, std::size_t queueFrames = 32);
+
+    // Calls finish() unless that already happened
+    ~AvRecorder();
+
+    // Both from the emulation thread, the samples of a frame before the frame itself like
+    // NesEmulator's callbacks
+    void addSamples(const qint32 *samples, std::size_t count);
+    void addFrame(const Frame &frame);
+
+    // Writes everything still queued and finishes the files, writeFailed() is final afterwards.
+    // Nothing may be added anymore.
+    void finish();
+
+    quint64 frames() const; // passed to addFrame(), dropped ones included
+    quint64 droppedFrames() const;
+    quint64 droppedSamples() const;
+    std::size_t queueCapacity() const;
+    bool writeFailed() const;
+
+private:
+    struct Packet {
+        Frame frame;
+        std::vector<qint32> samples; // m_maxPacketSamples, allocated once
+        std::size_t sampleCount;
+        quint32 droppedFramesBefore;
+    };
+
+    void writeHeaders();
+    void writePacket(const Packet &packet);
+    void writeVideoFrame(const Frame &frame);
+    void finishAudio();
+    void run();
+
+    QFile m_videoFile;
+    QFile m_audioFile;
+    const qint32 m_sampleRate;
+    const std::size_t m_maxPacketSamples; // 100ms, enough for a few dropped frames in a row
+
+    SpscRing<Packet> m_queue;
+
+    // emulation thread only
+    std::vector<qint32> m_pendingSamples; // capacity reserved once
+    quint32 m_pendingDroppedFrames {};
+    quint64 m_frames {};
+
+    // writer thread only
+    std::vector<quint8> m_videoBuffer;
+    Frame m_lastFrame {};
+    quint64 m_audioBytes {};
+
+    std::atomic<quint64> m_droppedFrames {};
+    std::atomic<quint64> m_droppedSamples {};
+    std::atomic<bool> m_writeFailed {};
+    std::atomic<bool> m_quit {};
+    bool m_finished {};
+
+    std::thread m_thread;
+};
@@ -0,0 +1,143 @@
+#include "blipbuffer.h"
+
+// system includes
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// local includes
+#include "snapshot.h"
+
+namespace {
+// passband up to 90% of nyquist, what is above gets folded back less than the blackman
+// window leaks
+constexpr double kernelCutoff = 0.9;
+}
+
+// Impulse response of a band limited step for every fractional position between two
+// samples, normalized so the deltas of a phase always sum up to the full step
+const BlipBuffer::Kernel BlipBuffer::m_kernel = [](){
+    Kernel kernel {};
+
+    for(int phase = 0; phase < phaseCount; phase++)
+    {
+        auto &taps = kernel[phase];
+
+        double sum = 0.;
+        for(int i = 0; i < kernelWidth; i++)
+        {
+            // distance to the delta, which sits between tap kernelWidth/2 - 1 and kernelWidth/2
+            const auto x = i - kernelWidth / 2 + 1 - double(phase) / phaseCount;
+            const auto sinc = x == 0. ? 1. : std::sin(M_PI * kernelCutoff * x) / (M_PI * kernelCutoff * x);
+            const auto w = (x + kernelWidth / 2.) / kernelWidth;
+            const auto window = 0.42 - 0.5 * std::cos(2. * M_PI * w) + 0.08 * std::cos(4. * M_PI * w);
+            taps[i] = sinc * window;
+            sum += taps[i];
+        }
+
+        for(auto &tap : taps)
+            tap /= sum;
+    }
+
+    return kernel;
+}();
+
+BlipBuffer::BlipBuffer(std::size_t capacity)
+{
+    setCapacity(capacity);
+}
+
+void BlipBuffer::setCapacity(std::size_t capacity)
+{
+    m_buffer.assign(std::max<std::size_t>(capacity, stateSamples) + kernelWidth, 0.);
+    m_offset = 0.;
+    m_available = 0;
+}
+
+void BlipBuffer::setRates(double clockRate, double sampleRate)
+{
+    m_factor = sampleRate / clockRate;
+}
+
+void BlipBuffer::clear()
+{
+    std::fill(m_buffer.begin(), m_buffer.end(), 0.);
+    m_offset = 0.;
+    m_integrator = 0.;
+    m_available = 0;
+}
+
+void BlipBuffer::addDelta(quint32 time, double delta)
+{
+    const auto position = m_offset + time * m_factor;
+    const auto sample = std::size_t(position);
+    // nobody read for longer than the capacity, a dropped delta would leave a dc offset
+    if(sample + kernelWidth > m_buffer.size())
+        grow(sample + kernelWidth);
+
+    const auto &taps = m_kernel[int((position - sample) * phaseCount)];
+    auto *out = &m_buffer[sample];
+    for(int i = 0; i < kernelWidth; i++)
+        out[i] += taps[i] * delta;
+}
+
+void BlipBuffer::endFrame(quint32 duration)
+{
+    m_offset += duration * m_factor;
+    if(std::size_t(m_offset) + kernelWidth > m_buffer.size())
+        grow(std::size_t(m_offset) + kernelWidth);
+
+    // later deltas only reach from their own sample onwards
+    m_available = std::size_t(m_offset);
+}
+
+std::size_t BlipBuffer::samplesAvailable() const
+{
+    return m_available;
+}
+
+std::size_t BlipBuffer::readSamples(double *samples, std::size_t count)
+{
+    count = std::min(count, m_available);
+
+    for(std::size_t i = 0; i < count; i++)
+    {
+        m_integrator += m_buffer[i];
+        samples[i] = m_integrator;
+    }
+
+    // move what is still accumulating to the front
+    const auto end = std::min(m_buffer.size(), std::size_t(m_offset) + kernelWidth);
+    std::copy(m_buffer.begin() + count, m_buffer.begin() + end, m_buffer.begin());
+    std::fill(m_buffer.begin() + (end - count), m_buffer.begin() + end, 0.);
+
+    m_offset -= count;
+    m_available -= count;
+
+    return count;
+}
+
+void BlipBuffer::grow(std::size_t end)
+{
+    m_buffer.resize(std::max(end, m_buffer.size() * 2), 0.);
+}
+
+void BlipBuffer::writeState(SnapshotWriter &snapshot) const
+{
+    if(std::size_t(m_offset) + kernelWidth > stateSamples)
+        throw std::runtime_error("savestates can only be taken between frames");
+
+    snapshot << m_offset << m_integrator;
+    for(int i = 0; i < stateSamples; i++)
+        snapshot << m_buffer[i];
+}
+
+void BlipBuffer::readState(SnapshotReader &snapshot)
+{
+    snapshot >> m_offset >> m_integrator;
+    std::fill(m_buffer.begin(), m_buffer.end(), 0.);
+    for(int i = 0; i < stateSamples; i++)
+        snapshot >> m_buffer[i];
+
+    m_available = std::min(std::size_t(m_offset), std::size_t(stateSamples));
+}
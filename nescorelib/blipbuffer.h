@@ -0,0 +1,61 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <array>
+#include <cstddef>
+#include <vector>
+
+// forward declarations
+class SnapshotReader;
+class SnapshotWriter;
+
+// Band limited step synthesis in the spirit of blargg's blip_buf. Amplitude changes get added
+// as deltas at the clock they happen, each one spread over a few output samples by a windowed
+// sinc kernel. endFrame() makes the samples up to that clock readable, readSamples() turns the
+// deltas back into levels with a running sum. Nothing is computed on clocks without a change.
+class NESCORELIB_EXPORT BlipBuffer
+{
+    Q_DISABLE_COPY(BlipBuffer)
+
+public:
+    // capacity is the samples expected between two reads, the buffer grows for longer frames
+    explicit BlipBuffer(std::size_t capacity = 0);
+
+    void setCapacity(std::size_t capacity);
+    void setRates(double clockRate, double sampleRate);
+    void clear();
+
+    // time is in clocks since the last endFrame()
+    void addDelta(quint32 time, double delta);
+    void endFrame(quint32 duration);
+
+    std::size_t samplesAvailable() const;
+    std::size_t readSamples(double *samples, std::size_t count);
+
+    // Only the kernel tail and a few samples past it are stored, that is everything pending
+    // right after endFrame() and the reads. Saving with more pending throws std::runtime_error,
+    // a fixed size cannot hold the audio of an unfinished frame.
+    void writeState(SnapshotWriter &snapshot) const;
+    void readState(SnapshotReader &snapshot);
+
+private:
+    static constexpr int phaseCount = 64;
+    static constexpr int kernelWidth = 16;
+    static constexpr int stateSamples = kernelWidth + 48;
+
+    using Kernel = std::array<std::array<double, kernelWidth>, phaseCount>;
+    static const Kernel m_kernel;
+
+    void grow(std::size_t end);
+
+    std::vector<double> m_buffer; // capacity + kernelWidth, the first one is the next to read
+    double m_factor {}; // samples per clock
+    double m_offset {}; // position of the current frame's first clock in m_buffer
+    double m_integrator {};
+    std::size_t m_available {};
+};
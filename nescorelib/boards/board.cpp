@@ -5,6 +5,12 @@
 
 // local includes
 #include "rom.h"
+#include "snapshot.h"
+
+namespace {
+// Read by disabled prg and chr ram pages
+const std::array<quint8, 0x1000> disabledPage {};
+}
 
 Board::Board(NesEmulator &emu, const Rom &rom) :
     m_emu(emu),
@@ -360,14 +366,44 @@ void Board::apuApplyChannelsSettings()
 {
 }
 
-void Board::readState(QDataStream &dataStream)
+void Board::readState(SnapshotReader &snapshot)
 {
-    Q_UNUSED(dataStream)
+    for(auto &page : m_prgRam)
+        snapshot >> page.ram >> page.enabled >> page.writeable >> page.battery;
+    for(auto &blk : m_prgAreaBlk)
+        snapshot >> blk.ram >> blk.index;
+
+    for(auto &page : m_chrRam)
+        snapshot >> page.ram >> page.enabled >> page.writeable >> page.battery;
+    for(auto &blk : m_chrAreaBlk)
+        snapshot >> blk.ram >> blk.index;
+
+    for(auto &nmt : m_nmtRam)
+        snapshot >> nmt.ram >> nmt.index;
+
+    snapshot >> m_oldVramAddress >> m_newVramAddress >> m_ppuCyclesTimer;
+
+    updatePrgReadPages();
+    updateChrReadPages();
+    updateNmtReadPages();
 }
 
-void Board::writeState(QDataStream &dataStream) const
+void Board::writeState(SnapshotWriter &snapshot) const
 {
-    Q_UNUSED(dataStream)
+    for(const auto &page : m_prgRam)
+        snapshot << page.ram << page.enabled << page.writeable << page.battery;
+    for(const auto &blk : m_prgAreaBlk)
+        snapshot << blk.ram << blk.index;
+
+    for(const auto &page : m_chrRam)
+        snapshot << page.ram << page.enabled << page.writeable << page.battery;
+    for(const auto &blk : m_chrAreaBlk)
+        snapshot << blk.ram << blk.index;
+
+    for(const auto &nmt : m_nmtRam)
+        snapshot << nmt.ram << nmt.index;
+
+    snapshot << m_oldVramAddress << m_newVramAddress << m_ppuCyclesTimer;
 }
 
 int Board::prgRam8KbDefaultBlkCount() const
@@ -393,6 +429,8 @@ bool Board::ppuA12TogglesOnRaisingEdge() const
 void Board::switch4kPrg(int index, PRGArea area)
 {
     m_prgAreaBlk[int(area)].index = index;
+
+    updatePrgReadPage(int(area));
 }
 
 void Board::switch8kPrg(int index, PRGArea area)
@@ -400,6 +438,9 @@ void Board::switch8kPrg(int index, PRGArea area)
     index *= 2;
     m_prgAreaBlk[int(area)].index = index;
     m_prgAreaBlk[int(area) + 1].index = index + 1;
+
+    for(int i = 0; i < 2; i++)
+        updatePrgReadPage(int(area) + i);
 }
 
 void Board::switch16kPrg(int index, PRGArea area)
@@ -409,6 +450,9 @@ void Board::switch16kPrg(int index, PRGArea area)
     m_prgAreaBlk[int(area) + 1].index = index + 1;
     m_prgAreaBlk[int(area) + 2].index = index + 2;
     m_prgAreaBlk[int(area) + 3].index = index + 3;
+
+    for(int i = 0; i < 4; i++)
+        updatePrgReadPage(int(area) + i);
 }
 
 void Board::switch32kPrg(int index, PRGArea area)
@@ -422,17 +466,25 @@ void Board::switch32kPrg(int index, PRGArea area)
     m_prgAreaBlk[int(area) + 5].index = index + 5;
     m_prgAreaBlk[int(area) + 6].index = index + 6;
     m_prgAreaBlk[int(area) + 7].index = index + 7;
+
+    for(int i = 0; i < 8; i++)
+        updatePrgReadPage(int(area) + i);
 }
 
 void Board::toggle4kPrgRam(bool ram, PRGArea area)
 {
     m_prgAreaBlk[int(area)].ram = ram;
+
+    updatePrgReadPage(int(area));
 }
 
 void Board::toggle8kPrgRam(bool ram, PRGArea area)
 {
     m_prgAreaBlk[int(area)].ram = ram;
     m_prgAreaBlk[int(area) + 1].ram = ram;
+
+    for(int i = 0; i < 2; i++)
+        updatePrgReadPage(int(area) + i);
 }
 
 void Board::toggle16kPrgRam(bool ram, PRGArea area)
@@ -441,6 +493,9 @@ void Board::toggle16kPrgRam(bool ram, PRGArea area)
     m_prgAreaBlk[int(area) + 1].ram = ram;
     m_prgAreaBlk[int(area) + 2].ram = ram;
     m_prgAreaBlk[int(area) + 3].ram = ram;
+
+    for(int i = 0; i < 4; i++)
+        updatePrgReadPage(int(area) + i);
 }
 
 void Board::toggle32kPrgRam(bool ram, PRGArea area)
@@ -453,12 +508,17 @@ void Board::toggle32kPrgRam(bool ram, PRGArea area)
     m_prgAreaBlk[int(area) + 5].ram = ram;
     m_prgAreaBlk[int(area) + 6].ram = ram;
     m_prgAreaBlk[int(area) + 7].ram = ram;
+
+    for(int i = 0; i < 8; i++)
+        updatePrgReadPage(int(area) + i);
 }
 
 void Board::togglePrgRamEnable(bool enable)
 {
     for(auto &page : m_prgRam)
         page.enabled = enable;
+
+    updatePrgReadPages();
 }
 
 void Board::togglePrgRamWritableEnable(bool enable)
@@ -470,6 +530,8 @@ void Board::togglePrgRamWritableEnable(bool enable)
 void Board::toggle4kPrgRamEnabled(bool enable, int index)
 {
     m_prgRam[index].enabled = enable;
+
+    updatePrgReadPages();
 }
 
 void Board::toggle4kPrgRamWritable(bool enable, int index)
@@ -482,9 +544,17 @@ void Board::toggle4kPrgRamBattery(bool enable, int index)
     m_prgRam[index].battery = enable;
 }
 
+void Board::toggle4kPrgReadHook(bool hook, PRGArea area)
+{
+    m_prgReadHooks[int(area)] = hook;
+    updatePrgReadPage(int(area));
+}
+
 void Board::switch1kChr(int index, CHRArea area)
 {
     m_chrAreaBlk[int(area)].index = index;
+
+    updateChrReadPage(int(area));
 }
 
 void Board::switch2kChr(int index, CHRArea area)
@@ -492,6 +562,9 @@ void Board::switch2kChr(int index, CHRArea area)
     index *= 2;
     m_chrAreaBlk[int(area)].index = index;
     m_chrAreaBlk[int(area) + 1].index = index + 1;
+
+    for(int i = 0; i < 2; i++)
+        updateChrReadPage(int(area) + i);
 }
 
 void Board::switch4kChr(int index, CHRArea area)
@@ -501,6 +574,9 @@ void Board::switch4kChr(int index, CHRArea area)
     m_chrAreaBlk[int(area) + 1].index = index + 1;
     m_chrAreaBlk[int(area) + 2].index = index + 2;
     m_chrAreaBlk[int(area) + 3].index = index + 3;
+
+    for(int i = 0; i < 4; i++)
+        updateChrReadPage(int(area) + i);
 }
 
 void Board::switch8kChr(int index)
@@ -508,17 +584,24 @@ void Board::switch8kChr(int index)
     index *= 8;
     for(int i = 0; i < 8; i++)
         m_chrAreaBlk[i].index = index + i;
+
+    updateChrReadPages();
 }
 
 void Board::toggle1kChrRam(bool ram, CHRArea area)
 {
     m_chrAreaBlk[int(area)].ram = ram;
+
+    updateChrReadPage(int(area));
 }
 
 void Board::toggle2kChrRam(bool ram, CHRArea area)
 {
     m_chrAreaBlk[int(area)].ram = ram;
     m_chrAreaBlk[int(area) + 1].ram = ram;
+
+    for(int i = 0; i < 2; i++)
+        updateChrReadPage(int(area) + i);
 }
 
 void Board::toggle4kChrRam(bool ram, CHRArea area)
@@ -527,17 +610,24 @@ void Board::toggle4kChrRam(bool ram, CHRArea area)
     m_chrAreaBlk[int(area) + 1].ram = ram;
     m_chrAreaBlk[int(area) + 2].ram = ram;
     m_chrAreaBlk[int(area) + 3].ram = ram;
+
+    for(int i = 0; i < 4; i++)
+        updateChrReadPage(int(area) + i);
 }
 
 void Board::toggle8kChrRam(bool ram)
 {
     for(auto &areaBlk : m_chrAreaBlk)
         areaBlk.ram = ram;
+
+    updateChrReadPages();
 }
 
 void Board::toggle1kChrRamEnabled(bool enable, int index)
 {
     m_chrRam[index].enabled = enable;
+
+    updateChrReadPages();
 }
 
 void Board::toggle1kChrRamWritable(bool enable, int index)
@@ -556,9 +646,17 @@ void Board::toggle1kChrRamBattery(bool enable, int index)
     m_chrRam[index].battery = enable;
 }
 
+void Board::toggle1kChrReadHook(bool hook, CHRArea area)
+{
+    m_chrReadHooks[int(area)] = hook;
+    updateChrReadPage(int(area));
+}
+
 void Board::switch1kNmt(int index, quint8 area)
 {
     m_nmtRam[area].index = index;
+
+    updateNmtReadPages();
 }
 
 void Board::switch1kNmt(Mirroring mirroring)
@@ -574,9 +672,104 @@ void Board::switch1kNmt(Mirroring mirroring)
     m_nmtRam[1].index = (int(mirroring) >> 2) & 0x3;
     m_nmtRam[2].index = (int(mirroring) >> 4) & 0x3;
     m_nmtRam[3].index = (int(mirroring) >> 6) & 0x3;
+
+    updateNmtReadPages();
+}
+
+void Board::toggle1kNmtReadHook(bool hook, quint8 area)
+{
+    m_nmtReadHooks[area] = hook;
+    updateNmtReadPages();
 }
 
 bool Board::enableExternalSound() const
 {
     return false;
 }
+
+quint32 Board::hooks() const
+{
+    // boards not knowing better get everything
+    quint32 hooks = HookCpuClock | HookPpuClock | HookPpuAddressUpdate | HookPpuScanlineTick;
+    if(enableExternalSound())
+        hooks |= HookExternalSound;
+    return hooks;
+}
+
+bool Board::ppuCatchUpAllowed() const
+{
+    return !ppuA12ToggleTimerEnabled();
+}
+
+bool Board::prgReadPageIsRom(quint16 address) const
+{
+    const auto area = address >> 12;
+    return area >= int(PRGArea::Area5000) && !m_prgReadHooks[area] && !m_prgAreaBlk[area].ram;
+}
+
+void Board::updatePrgReadPage(int area)
+{
+    // 0xxx - 4xxx are wram and io, they never come from the board
+    if(area < int(PRGArea::Area5000) || m_prgReadHooks[area])
+    {
+        m_prgReadPages[area] = nullptr;
+        return;
+    }
+
+    if(m_prgAreaBlk[area].ram)
+    {
+        if(m_prgRam.isEmpty())
+        {
+            m_prgReadPages[area] = disabledPage.data();
+            return;
+        }
+
+        const auto &page = m_prgRam[m_prgAreaBlk[area].index & prgRam4KbMask()];
+        m_prgReadPages[area] = page.enabled ? page.ram.data() : disabledPage.data();
+    }
+    else
+        m_prgReadPages[area] = m_rom.prg[m_prgAreaBlk[area].index & prgRom4KbMask()].data();
+}
+
+void Board::updatePrgReadPages()
+{
+    for(std::size_t area = 0; area < m_prgReadPages.size(); area++)
+        updatePrgReadPage(area);
+}
+
+void Board::updateChrReadPage(int area)
+{
+    if(m_chrReadHooks[area])
+    {
+        m_chrReadPages[area] = nullptr;
+        return;
+    }
+
+    if(m_chrAreaBlk[area].ram)
+    {
+        if(m_chrRam.isEmpty())
+        {
+            m_chrReadPages[area] = disabledPage.data();
+            return;
+        }
+
+        const auto &page = m_chrRam[m_chrAreaBlk[area].index & chrRam1KbMask()];
+        m_chrReadPages[area] = page.enabled ? page.ram.data() : disabledPage.data();
+    }
+    else if(m_rom.chr.isEmpty())
+        m_chrReadPages[area] = disabledPage.data();
+    else
+        m_chrReadPages[area] = m_rom.chr[m_chrAreaBlk[area].index & chrRom1KbMask()].data();
+}
+
+void Board::updateChrReadPages()
+{
+    for(std::size_t area = 0; area < m_chrReadPages.size(); area++)
+        updateChrReadPage(area);
+}
+
+void Board::updateNmtReadPages()
+{
+    for(std::size_t area = 0; area < m_nmtReadPages.size(); area++)
+        m_nmtReadPages[area] = m_nmtReadHooks[area] ? nullptr : m_nmtRam[m_nmtRam[area].index].ram.data();
+}
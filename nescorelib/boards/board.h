@@ -16,7 +16,8 @@
 #include "enums/chrarea.h"
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 
 class NesEmulator;
 
@@ -25,6 +26,17 @@ class NESCORELIB_EXPORT Board
     Q_DISABLE_COPY(Board)
 
 public:
+    // Clock callbacks a board actually implements, see hooks()
+    enum Hook : quint32 {
+        HookNone = 0x00,
+        HookCpuClock = 0x01, // onCpuClock()
+        HookPpuClock = 0x02, // onPpuClock()
+        HookPpuAddressUpdate = 0x04, // onPpuAddressUpdate()
+        HookPpuScanlineTick = 0x08, // onPpuScanlineTick()
+        HookExternalSound = 0x10, // onApuClock*() and apuGetSample()
+        HookAll = 0x1F
+    };
+
     explicit Board(NesEmulator &emu, const Rom &rom);
     virtual ~Board();
 
@@ -62,11 +74,33 @@ public:
     virtual double apuGetSample() const;
     virtual void apuApplyChannelsSettings();
 
-    virtual void readState(QDataStream &dataStream);
-    virtual void writeState(QDataStream &dataStream) const;
+    virtual void readState(SnapshotReader &snapshot);
+    virtual void writeState(SnapshotWriter &snapshot) const;
 
     virtual bool enableExternalSound() const;
 
+    // Which of the per clock callbacks have to be called at all. Queried once when the rom
+    // gets loaded, the emulator skips the others entirely.
+    virtual quint32 hooks() const;
+
+    // Whether the ppu may lag behind the cpu between observable events. Boards that watch
+    // the ppu address bus, count ppu clocks or expose ppu state through their registers
+    // must return false.
+    virtual bool ppuCatchUpAllowed() const;
+
+    // Direct pointer into the 4kb prg page mapped at address, nullptr when the read has to go
+    // through readEx(), readSrm() or readPrg(). Boards overriding those for reads with side
+    // effects must hook the areas with toggle4kPrgReadHook().
+    const quint8 *prgReadPage(quint16 address) const { return m_prgReadPages[address >> 12]; }
+
+    // Whether that page is prg rom, its content can never change then
+    bool prgReadPageIsRom(quint16 address) const;
+
+    // Same for the 1kb chr pages and the nametables seen by the ppu, hooked with
+    // toggle1kChrReadHook() and toggle1kNmtReadHook().
+    const quint8 *chrReadPage(quint16 address) const { return m_chrReadPages[(address >> 10) & 0x7]; }
+    const quint8 *nmtReadPage(quint16 address) const { return m_nmtReadPages[(address >> 10) & 0x3]; }
+
 protected:
     virtual int prgRam8KbDefaultBlkCount() const;
     virtual int chrRom1KbDefaultBlkCount() const;
@@ -86,6 +120,7 @@ protected:
     void toggle4kPrgRamEnabled(bool enable, int index);
     void toggle4kPrgRamWritable(bool enable, int index);
     void toggle4kPrgRamBattery(bool enable, int index);
+    void toggle4kPrgReadHook(bool hook, PRGArea area);
     void switch1kChr(int index, CHRArea area);
     void switch2kChr(int index, CHRArea area);
     void switch4kChr(int index, CHRArea area);
@@ -98,8 +133,10 @@ protected:
     void toggle1kChrRamWritable(bool enable, int index);
     void toggleChrRamWritableEnable(bool enable);
     void toggle1kChrRamBattery(bool enable, int index);
+    void toggle1kChrReadHook(bool hook, CHRArea area);
     void switch1kNmt(int index, quint8 area);
     void switch1kNmt(Mirroring mirroring);
+    void toggle1kNmtReadHook(bool hook, quint8 area);
 
     int prgRom4KbCount() const { return m_rom.prg.size(); }
     int prgRom4KbMask() const { return prgRom4KbCount() - 1; }
@@ -169,6 +206,18 @@ protected:
     const Rom m_rom;
 
 private:
+    void updatePrgReadPage(int area);
+    void updatePrgReadPages();
+    void updateChrReadPage(int area);
+    void updateChrReadPages();
+    void updateNmtReadPages();
+
+    std::array<const quint8*, 16> m_prgReadPages {}; // Starting from 0xxx to Fxxx, the page reads of an area come from
+    std::array<bool, 16> m_prgReadHooks {}; // Indicates if reads of an area always go through the virtual handlers
+    std::array<const quint8*, 8> m_chrReadPages {};
+    std::array<bool, 8> m_chrReadHooks {};
+    std::array<const quint8*, 4> m_nmtReadPages {};
+    std::array<bool, 4> m_nmtReadHooks {};
 
     bool m_sramSaveRequired {};
 };
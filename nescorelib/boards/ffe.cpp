@@ -1,10 +1,8 @@
 #include "ffe.h"
 
-// Qt includes
-#include <QDataStream>
-
 // local includes
 #include "nesemulator.h"
+#include "snapshot.h"
 
 Ffe::Ffe(NesEmulator &emu, const Rom &rom) :
     Board(emu, rom)
@@ -46,14 +44,14 @@ void Ffe::onCpuClock()
     }
 }
 
-void Ffe::readState(QDataStream &dataStream)
+void Ffe::readState(SnapshotReader &snapshot)
 {
-    Board::readState(dataStream);
-    dataStream >> m_irqEnable >> m_irqCounter;
+    Board::readState(snapshot);
+    snapshot >> m_irqEnable >> m_irqCounter;
 }
 
-void Ffe::writeState(QDataStream &dataStream) const
+void Ffe::writeState(SnapshotWriter &snapshot) const
 {
-    Board::writeState(dataStream);
-    dataStream << m_irqEnable << m_irqCounter;
+    Board::writeState(snapshot);
+    snapshot << m_irqEnable << m_irqCounter;
 }
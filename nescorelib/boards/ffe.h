@@ -11,8 +11,8 @@ public:
 
     void writeEx(quint16 address, quint8 value) Q_DECL_OVERRIDE;
     void onCpuClock() Q_DECL_OVERRIDE;
-    void readState(QDataStream &dataStream) Q_DECL_OVERRIDE;
-    void writeState(QDataStream &dataStream) const Q_DECL_OVERRIDE;
+    void readState(SnapshotReader &snapshot) Q_DECL_OVERRIDE;
+    void writeState(SnapshotWriter &snapshot) const Q_DECL_OVERRIDE;
 
 private:
     bool m_irqEnable;
@@ -0,0 +1,32 @@
+#include "crc32.h"
+
+// system includes
+#include <array>
+
+namespace {
+constexpr std::array<quint32, 256> makeTable()
+{
+    std::array<quint32, 256> table {};
+    for(quint32 i = 0; i < 256; i++)
+    {
+        auto value = i;
+        for(auto bit = 0; bit < 8; bit++)
+            value = (value & 1) ? (value >> 1) ^ 0xEDB88320 : value >> 1;
+        table[i] = value;
+    }
+    return table;
+}
+
+constexpr auto table = makeTable();
+}
+
+quint32 crc32(const void *data, std::size_t size, quint32 crc)
+{
+    const auto bytes = static_cast<const quint8*>(data);
+
+    crc = ~crc;
+    for(std::size_t i = 0; i < size; i++)
+        crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+
+    return ~crc;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <cstddef>
+
+// The usual zlib/png crc32, pass the previous result as crc to continue a checksum.
+NESCORELIB_EXPORT quint32 crc32(const void *data, std::size_t size, quint32 crc = 0);
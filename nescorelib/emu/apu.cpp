@@ -1,27 +1,26 @@
 #include "apu.h"
 
-// Qt includes
-#include <QDataStream>
-
 // system includes
 #include <algorithm>
 
 // local includes
 #include "nesemulator.h"
 #include "emusettings.h"
+#include "snapshot.h"
 
 Apu::Apu(NesEmulator &emu) :
-    QObject(&emu),
     m_emu(emu),
     m_dmc(*this),
     m_nos(*this),
     m_sq1(*this),
     m_sq2(*this),
     m_trl(*this),
-    m_lowPassFilter(0.815686),   // 14 KHz
-    m_highPassFilter1(0.999835), // 90 Hz
-    m_highPassFilter2(0.996039)  // 442 Hz
+    m_lowPassFilter(14000.),
+    m_highPassFilter1(90.),
+    m_highPassFilter2(442.)
 {
+    setSampleRate(44100);
+    setSampleBufferCapacity(16384);
 }
 
 void Apu::hardReset()
@@ -50,11 +49,12 @@ void Apu::hardReset()
     m_irqEnabled = true;
     m_irqFlag = false;
 
-    m_timer = 0.;
-    m_audioX = 0.;
-    m_audioX1 = 0.;
-    m_audioY = 0.;
-    m_audioYClocks = 0.;
+    m_amplitude = 0.;
+    m_frameClock = 0;
+    m_syncClock = 0;
+    m_syncOddCycle = !m_oddCycle;
+    m_mixedDmcOutput = m_dmc.output();
+    m_blip.clear();
 
     m_highPassFilter1.reset();
     m_highPassFilter2.reset();
@@ -63,6 +63,9 @@ void Apu::hardReset()
 
 void Apu::softReset()
 {
+    // what played up to now stays
+    syncChannels(m_frameClock);
+
     m_regIoDb = 0;
     m_regIoAddr = 0;
     m_regAccessHappened = false;
@@ -86,6 +89,10 @@ void Apu::softReset()
     m_trl.apuTrlSoftReset();
     m_nos.apuNosSoftReset();
     m_dmc.apuDmcSoftReset();
+
+    m_syncOddCycle = !m_oddCycle;
+    m_mixedDmcOutput = m_dmc.output();
+    mix(m_frameClock);
 }
 
 quint8 Apu::_ioRead(const quint16 address)
@@ -306,6 +313,7 @@ void Apu::clock()
         if(m_regAccessHappened)
         {
             m_regAccessHappened = false;
+            syncChannels(m_frameClock);
             switch(m_regIoAddr)
             {
             case 0: m_sq1.apuOnRegister4000(); break;
@@ -343,23 +351,25 @@ void Apu::clock()
             }
         }
 
-        m_sq1.apuSq1Clock();
-        m_sq2.apuSq2Clock();
-        m_nos.apuNosClock();
-
-        if(m_emu.memory().board()->enableExternalSound())
+        if(m_emu.memory().boardHooked(Board::HookExternalSound))
+        {
+            NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardExternalSound);
             m_emu.memory().board()->onApuClock();
+        }
 
         //apuUpdatePlayback();
     }
 
-    m_trl.apuTrlClock();
     m_dmc.apuDmcClock();
 
-    if(m_emu.memory().board()->enableExternalSound())
+    if(m_emu.memory().boardHooked(Board::HookExternalSound))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardExternalSound);
         m_emu.memory().board()->onApuClockSingle();
+    }
 
-    updatePlayback();
+    if(m_audioEnabled)
+        updatePlayback();
 
     if(m_checkIrq)
     {
@@ -375,23 +385,33 @@ void Apu::clock()
 
 void Apu::clockDuration()
 {
+    syncChannels(m_frameClock);
+
     m_sq1.apuSq1ClockLength();
     m_sq2.apuSq2ClockLength();
     m_nos.apuNosClockLength();
     m_trl.apuTrlClockLength();
-    if(m_emu.memory().board()->enableExternalSound())
+    if(m_emu.memory().boardHooked(Board::HookExternalSound))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardExternalSound);
         m_emu.memory().board()->onApuClockDuration();
+    }
     m_doLength = false;
 }
 
 void Apu::clockEnvelope()
 {
+    syncChannels(m_frameClock);
+
     m_sq1.apuSq1ClockEnvelope();
     m_sq2.apuSq2ClockEnvelope();
     m_nos.apuNosClockEnvelope();
     m_trl.apuTrlClockEnvelope();
-    if(m_emu.memory().board()->enableExternalSound())
+    if(m_emu.memory().boardHooked(Board::HookExternalSound))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardExternalSound);
         m_emu.memory().board()->onApuClockEnvelope();
+    }
     m_doEnv = false;
 }
 
@@ -404,6 +424,83 @@ void Apu::checkIrq()
 }
 
 void Apu::updatePlayback()
+{
+    NESCORE_PROFILE_SCOPE(m_emu.profiler(), ApuUpdatePlayback);
+
+    // the lazy channels only change on their steps, the dmc and external sound are clocked
+    // every cycle and can change the level any time
+    if(m_dmc.output() != m_mixedDmcOutput || m_emu.memory().boardHooked(Board::HookExternalSound))
+    {
+        // the steps before this clock still played with the old dmc level
+        syncChannels(m_frameClock);
+        m_mixedDmcOutput = m_dmc.output();
+        syncChannels(m_frameClock + 1);
+        mix(m_frameClock);
+    }
+
+    m_frameClock++;
+}
+
+void Apu::syncChannels(quint32 clock)
+{
+    while(m_syncClock < clock)
+    {
+        // sq1, sq2 and nos get clocked on even cycles only, trl on every one
+        const auto firstEven = m_syncClock + (m_syncOddCycle ? 1 : 0);
+        const auto sq1Step = firstEven + 2 * quint32(m_sq1.apuSq1ClocksUntilStep() - 1);
+        const auto sq2Step = firstEven + 2 * quint32(m_sq2.apuSq2ClocksUntilStep() - 1);
+        const auto nosStep = firstEven + 2 * quint32(m_nos.apuNosClocksUntilStep() - 1);
+        const auto trlStep = m_syncClock + quint32(m_trl.apuTrlClocksUntilStep() - 1);
+        const auto step = std::min({ sq1Step, sq2Step, nosStep, trlStep });
+
+        // up to and including the step or to the end when there is none
+        const auto stepped = step < clock;
+        const auto end = stepped ? step + 1 : clock;
+        const auto clocks = qint32(end - m_syncClock);
+        const auto evenClocks = m_syncOddCycle ? clocks / 2 : (clocks + 1) / 2;
+
+        if(stepped && sq1Step == step)
+        {
+            m_sq1.apuSq1Skip(evenClocks - 1);
+            m_sq1.apuSq1Step();
+        }
+        else
+            m_sq1.apuSq1Skip(evenClocks);
+
+        if(stepped && sq2Step == step)
+        {
+            m_sq2.apuSq2Skip(evenClocks - 1);
+            m_sq2.apuSq2Step();
+        }
+        else
+            m_sq2.apuSq2Skip(evenClocks);
+
+        if(stepped && nosStep == step)
+        {
+            m_nos.apuNosSkip(evenClocks - 1);
+            m_nos.apuNosStep();
+        }
+        else
+            m_nos.apuNosSkip(evenClocks);
+
+        if(stepped && trlStep == step)
+        {
+            m_trl.apuTrlSkip(clocks - 1);
+            m_trl.apuTrlStep();
+        }
+        else
+            m_trl.apuTrlSkip(clocks);
+
+        m_syncClock = end;
+        if(clocks & 1)
+            m_syncOddCycle = !m_syncOddCycle;
+
+        if(stepped)
+            mix(step);
+    }
+}
+
+void Apu::mix(quint32 clock)
 {
     static constexpr std::array<qreal, 32> audioPulseTable = []() constexpr {
         std::array<qreal, 32> audioPulseTable {};
@@ -419,91 +516,111 @@ void Apu::updatePlayback()
         return audioTndTable;
     }();
 
-    // Collect the sample
-    m_pulseOut = audioPulseTable[m_sq1.output() + m_sq2.output()];
-    m_tndOut = audioTndTable[(3 * m_trl.output()) + (2 * m_nos.output()) + m_dmc.output()];
+    auto amplitude = audioPulseTable[m_sq1.output() + m_sq2.output()]
+                   + audioTndTable[(3 * m_trl.output()) + (2 * m_nos.output()) + m_mixedDmcOutput];
 
-    m_audioX = m_pulseOut + m_tndOut;
-
-    if(m_emu.memory().board()->enableExternalSound())
+    if(m_emu.memory().boardHooked(Board::HookExternalSound))
     {
-        m_audioX += m_emu.memory().board()->apuGetSample();
-        m_audioX /= 2;
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardExternalSound);
+        amplitude += m_emu.memory().board()->apuGetSample();
+        amplitude /= 2;
     }
 
-    m_audioX *= EmuSettings::Audio::internalAmplitude;
+    amplitude *= EmuSettings::Audio::internalAmplitude;
 
-    // An implementation of the "Band-Limited Sound Synthesis" algorithm.
-    // http://www.slack.net/~ant/bl-synth
-    // Shay Green <hotpop.com@blargg> (swap to e-mail)
-    // No sure about this, it just add the sample difference in each step.
-    // Maybe here it is acting just like a low-pass filter ...
-    if(m_audioX != m_audioX1)
+    // only the changes go into the band limited synthesis
+    if(amplitude != m_amplitude)
     {
-        if(m_audioX > m_audioX1)
-            m_audioY += m_audioX - m_audioX1;
-        else
-            m_audioY += m_audioX1 - m_audioX;
-
-        m_audioX = m_audioX1;
+        m_blip.addDelta(clock, amplitude - m_amplitude);
+        m_amplitude = amplitude;
     }
+}
 
-    m_audioYClocks++;
-    m_timer++;
+void Apu::writeState(SnapshotWriter &snapshot) const
+{
+    snapshot << m_regIoDb << m_regIoAddr << m_regAccessHappened << m_regAccessW << m_oddCycle << m_irqEnabled << m_irqFlag << m_irqDeltaOccur
+             << m_seqMode << m_cycleF << m_cycleE << m_cycleL << m_oddL << m_cycleFt << m_checkIrq << m_doEnv << m_doLength << m_inputStrobe
+             << m_amplitude << m_frameClock << m_syncClock << m_syncOddCycle;
 
-    const auto audiotimerratio = m_freqL * 2. * 120. / m_sampleRate;
+    m_blip.writeState(snapshot);
 
-    if(m_timer >= audiotimerratio)
-    {
-        // Clock by output sample rate.
-        m_timer -= audiotimerratio;
+    m_lowPassFilter.writeState(snapshot);
+    m_highPassFilter1.writeState(snapshot);
+    m_highPassFilter2.writeState(snapshot);
 
-        // Get the sum of the samples
-        m_audioY /= m_audioYClocks;
+    m_sq1.apuSq1WriteState(snapshot);
+    m_sq2.apuSq2WriteState(snapshot);
+    m_nos.apuNosWriteState(snapshot);
+    m_trl.apuTrlWriteState(snapshot);
+    m_dmc.apuDmcWriteState(snapshot);
+}
 
-        // Do filtering, add 2 high-pass and one low-pass filters. See http://wiki.nesdev.com/w/index.php/APUMixer
-        double audioDcY;
-        audioDcY = m_highPassFilter2.doFiltering(m_audioY);// 442 Hz
-        audioDcY = m_highPassFilter1.doFiltering(audioDcY);// 90 Hz
-        audioDcY = m_lowPassFilter.doFiltering(audioDcY);// 14 KHz
-        audioDcY = std::clamp(audioDcY, double(-EmuSettings::Audio::internalPeekLimit), double(EmuSettings::Audio::internalPeekLimit));
+void Apu::readState(SnapshotReader &snapshot)
+{
+    snapshot >> m_regIoDb >> m_regIoAddr >> m_regAccessHappened >> m_regAccessW >> m_oddCycle >> m_irqEnabled >> m_irqFlag >> m_irqDeltaOccur
+             >> m_seqMode >> m_cycleF >> m_cycleE >> m_cycleL >> m_oddL >> m_cycleFt >> m_checkIrq >> m_doEnv >> m_doLength >> m_inputStrobe
+             >> m_amplitude >> m_frameClock >> m_syncClock >> m_syncOddCycle;
 
-        m_samples.append(audioDcY);
+    m_blip.readState(snapshot);
 
-        m_audioY = 0;
-        m_audioYClocks = 0;
+    m_lowPassFilter.readState(snapshot);
+    m_highPassFilter1.readState(snapshot);
+    m_highPassFilter2.readState(snapshot);
+
+    m_sq1.apuSq1ReadState(snapshot);
+    m_sq2.apuSq2ReadState(snapshot);
+    m_nos.apuNosReadState(snapshot);
+    m_trl.apuTrlReadState(snapshot);
+    m_dmc.apuDmcReadState(snapshot);
+
+    m_mixedDmcOutput = m_dmc.output();
+
+    // the snapshot may come from an instance with audio, nothing gets mixed here
+    if(!m_audioEnabled)
+    {
+        m_frameClock = 0;
+        m_syncClock = 0;
     }
 }
 
-void Apu::writeState(QDataStream &dataStream) const
+void Apu::flush()
 {
-    dataStream << m_regIoDb << m_regIoAddr << m_regAccessHappened << m_regAccessW << m_oddCycle << m_irqEnabled << m_irqFlag << m_irqDeltaOccur
-               << m_seqMode << m_cycleF << m_cycleE << m_cycleL << m_oddL << m_cycleFt << m_checkIrq << m_doEnv << m_doLength << m_inputStrobe;
+    if(!m_audioEnabled)
+        return;
 
-    m_sq1.apuSq1WriteState(dataStream);
-    m_sq2.apuSq2WriteState(dataStream);
-    m_nos.apuNosWriteState(dataStream);
-    m_trl.apuTrlWriteState(dataStream);
-    m_dmc.apuDmcWriteState(dataStream);
-}
+    syncChannels(m_frameClock);
 
-void Apu::readState(QDataStream &dataStream)
-{
-    dataStream >> m_regIoDb >> m_regIoAddr >> m_regAccessHappened >> m_regAccessW >> m_oddCycle >> m_irqEnabled >> m_irqFlag >> m_irqDeltaOccur
-               >> m_seqMode >> m_cycleF >> m_cycleE >> m_cycleL >> m_oddL >> m_cycleFt >> m_checkIrq >> m_doEnv >> m_doLength >> m_inputStrobe;
+    m_blip.endFrame(m_frameClock);
+    m_frameClock = 0;
+    m_syncClock = 0;
 
-    m_sq1.apuSq1ReadState(dataStream);
-    m_sq2.apuSq2ReadState(dataStream);
-    m_nos.apuNosReadState(dataStream);
-    m_trl.apuTrlReadState(dataStream);
-    m_dmc.apuDmcReadState(dataStream);
-}
+    // a frame longer than a tenth of a second made the blip buffer grow
+    if(m_blip.samplesAvailable() > m_mixedSamples.size())
+        m_mixedSamples.resize(m_blip.samplesAvailable());
 
-void Apu::flush()
-{
-    m_timer = 0;
-    Q_EMIT samplesFinished(m_samples);
-    m_samples.clear();
+    const auto count = m_blip.readSamples(m_mixedSamples.data(), m_mixedSamples.size());
+
+    // Do filtering, add 2 high-pass and one low-pass filters. See http://wiki.nesdev.com/w/index.php/APUMixer
+    for(std::size_t i = 0; i < count; i++)
+    {
+        double audioDcY;
+        audioDcY = m_highPassFilter2.doFiltering(m_mixedSamples[i]);// 442 Hz
+        audioDcY = m_highPassFilter1.doFiltering(audioDcY);// 90 Hz
+        audioDcY = m_lowPassFilter.doFiltering(audioDcY);// 14 KHz
+        audioDcY = std::clamp(audioDcY, double(-EmuSettings::Audio::internalPeekLimit), double(EmuSettings::Audio::internalPeekLimit));
+
+        if(m_sampleWrite - m_sampleRead == m_sampleBuffer.size())
+        {
+            // drop the oldest one
+            m_sampleRead++;
+            m_sampleOverruns++;
+        }
+
+        m_sampleBuffer[m_sampleWrite++ & (m_sampleBuffer.size() - 1)] = audioDcY;
+    }
+
+    // a changed adjustment applies from the next frame on
+    m_blip.setRates(EmuSettings::cpuClockRate, m_sampleRate * m_sampleRateAdjustment);
 }
 
 bool Apu::oddCycle() const
@@ -608,7 +725,52 @@ qint32 Apu::sampleRate() const
 
 void Apu::setSampleRate(qint32 sampleRate)
 {
+    Q_ASSERT(sampleRate > 0);
+
     m_sampleRate = sampleRate;
+
+    // room for a tenth of a second, frames are a lot shorter
+    m_blip.setCapacity(sampleRate / 10);
+    m_blip.setRates(EmuSettings::cpuClockRate, m_sampleRate * m_sampleRateAdjustment);
+    m_mixedSamples.resize(sampleRate / 10);
+
+    m_highPassFilter1.setSampleRate(sampleRate);
+    m_highPassFilter2.setSampleRate(sampleRate);
+    m_lowPassFilter.setSampleRate(sampleRate);
+}
+
+double Apu::sampleRateAdjustment() const
+{
+    return m_sampleRateAdjustment;
+}
+
+void Apu::setSampleRateAdjustment(double sampleRateAdjustment)
+{
+    m_sampleRateAdjustment = sampleRateAdjustment;
+}
+
+bool Apu::audioEnabled() const
+{
+    return m_audioEnabled;
+}
+
+void Apu::setAudioEnabled(bool audioEnabled)
+{
+    if(audioEnabled == m_audioEnabled)
+        return;
+
+    m_audioEnabled = audioEnabled;
+
+    // the frame in progress gets dropped, the waveforms continue where they stand
+    m_amplitude = 0.;
+    m_frameClock = 0;
+    m_syncClock = 0;
+    m_syncOddCycle = !m_oddCycle;
+    m_mixedDmcOutput = m_dmc.output();
+    m_blip.clear();
+
+    if(m_audioEnabled)
+        mix(m_frameClock);
 }
 
 const std::array<std::array<quint8, 8>, 4> Apu::m_sqDutyCycleSequences {
@@ -622,3 +784,59 @@ const std::array<quint8, 32> Apu::m_sqDurationTable {
     0x0A, 0xFE, 0x14, 0x02, 0x28, 0x04, 0x50, 0x06, 0xA0, 0x08, 0x3C, 0x0A, 0x0E, 0x0C, 0x1A, 0x0E,
     0x0C, 0x10, 0x18, 0x12, 0x30, 0x14, 0x60, 0x16, 0xC0, 0x18, 0x48, 0x1A, 0x10, 0x1C, 0x20, 0x1E,
 };
+
+std::size_t Apu::sampleBufferCapacity() const
+{
+    return m_sampleBuffer.size();
+}
+
+void Apu::setSampleBufferCapacity(std::size_t sampleBufferCapacity)
+{
+    std::size_t capacity = 1;
+    while(capacity < sampleBufferCapacity)
+        capacity *= 2;
+
+    m_sampleBuffer.assign(capacity, 0);
+    m_sampleRead = 0;
+    m_sampleWrite = 0;
+}
+
+std::size_t Apu::samplesAvailable() const
+{
+    return m_sampleWrite - m_sampleRead;
+}
+
+std::size_t Apu::readSamples(qint32 *samples, std::size_t count)
+{
+    const auto available = samplesAvailable();
+    if(count > available)
+    {
+        m_sampleUnderruns += count - available;
+        count = available;
+    }
+
+    // at most two copies, the second one after wrapping around
+    const auto start = m_sampleRead & (m_sampleBuffer.size() - 1);
+    const auto first = std::min(count, m_sampleBuffer.size() - start);
+    std::copy_n(m_sampleBuffer.cbegin() + start, first, samples);
+    std::copy_n(m_sampleBuffer.cbegin(), count - first, samples + first);
+
+    m_sampleRead += count;
+    return count;
+}
+
+quint64 Apu::sampleOverruns() const
+{
+    return m_sampleOverruns;
+}
+
+quint64 Apu::sampleUnderruns() const
+{
+    return m_sampleUnderruns;
+}
+
+void Apu::resetSampleCounters()
+{
+    m_sampleOverruns = 0;
+    m_sampleUnderruns = 0;
+}
@@ -1,16 +1,16 @@
 #pragma once
 
 #include "nescorelib_global.h"
-#include <QObject>
 
 // Qt includes
 #include <QtGlobal>
-#include <QVector>
 
 // system includes
 #include <array>
+#include <vector>
 
 // local includes
+#include "blipbuffer.h"
 #include "apudmc.h"
 #include "apunos.h"
 #include "apusq1.h"
@@ -20,12 +20,13 @@
 #include "soundhighpassfilter.h"
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 class NesEmulator;
 
-class NESCORELIB_EXPORT Apu : public QObject
+class NESCORELIB_EXPORT Apu
 {
-    Q_OBJECT
+    Q_DISABLE_COPY(Apu)
 
 public:
     explicit Apu(NesEmulator &emu);
@@ -53,9 +54,16 @@ public:
     void checkIrq();
     void updatePlayback();
 
-    void writeState(QDataStream &dataStream) const;
-    void readState(QDataStream &dataStream);
+    // Catches sq1, sq2, nos and trl up with every clock before the given one of this frame,
+    // mixing at each of their steps. They only get advanced before something changes their
+    // state and when the level is needed, so silent or slow channels cost nothing per clock.
+    void syncChannels(quint32 clock);
+    void mix(quint32 clock);
 
+    void writeState(SnapshotWriter &snapshot) const;
+    void readState(SnapshotReader &snapshot);
+
+    // Ends the audio frame, the samples of the frame get filtered and are readable after
     void flush();
 
     bool oddCycle() const;
@@ -85,15 +93,38 @@ public:
 
     quint8 regIoAddr() const;
 
+    // Any rate works, 22050, 44100, 48000 and 96000 Hz are the usual ones. Clears the samples
+    // not read yet.
     qint32 sampleRate() const;
     void setSampleRate(qint32 sampleRate);
 
+    // Factor on the rate samples get generated at, lets a frontend speed up or slow down
+    // the stream slightly to follow the clock of the audio device. Not part of the state.
+    double sampleRateAdjustment() const;
+    void setSampleRateAdjustment(double sampleRateAdjustment);
+
+    // Switched off, nothing gets mixed or synthesized and flush() yields no samples. Everything
+    // the cpu can see keeps its timing: $4015, the frame irq, the length counters and sweeps,
+    // the dmc with its dma and irq. The channel waveforms stand still meanwhile and switching
+    // drops the samples of the frame in progress. Not part of the state.
+    bool audioEnabled() const;
+    void setAudioEnabled(bool audioEnabled);
+
+    // The generated samples are kept in a preallocated ring until they get pulled with
+    // readSamples(). When nobody reads fast enough the oldest ones get overwritten.
+    std::size_t sampleBufferCapacity() const;
+    void setSampleBufferCapacity(std::size_t sampleBufferCapacity);
+    std::size_t samplesAvailable() const;
+    std::size_t readSamples(qint32 *samples, std::size_t count);
+
+    // Number of samples dropped because the ring was full / missing when reading
+    quint64 sampleOverruns() const;
+    quint64 sampleUnderruns() const;
+    void resetSampleCounters();
+
     static const std::array<std::array<quint8, 8>, 4> m_sqDutyCycleSequences;
     static const std::array<quint8, 32> m_sqDurationTable;
 
-Q_SIGNALS:
-    void samplesFinished(const QVector<qint32> &samples);
-
 private:
     NesEmulator &m_emu;
 
@@ -127,17 +158,15 @@ private:
     bool m_doEnv {};
     bool m_doLength {};
 
-    //DAC
-    double m_pulseOut {};
-    double m_tndOut {};
-
     //Output values
-    double m_audioX {};
-    double m_audioX1 {};
-    double m_audioY {};
-    double m_audioYClocks {};
-    static constexpr double m_audioDcR = 0.995;
-    double m_timer {};
+    double m_amplitude {}; // mixer output as of the last change
+    quint32 m_frameClock {}; // clocks since the last flush()
+    quint32 m_syncClock {}; // first clock of this frame the lazy channels did not see yet
+    bool m_syncOddCycle {}; // m_oddCycle of that clock
+    qint32 m_mixedDmcOutput {}; // dmc level the lazy channels get mixed with
+    BlipBuffer m_blip;
+    std::vector<double> m_mixedSamples; // flush() only, preallocated
+    bool m_audioEnabled { true };
 
     SoundLowPassFilter m_lowPassFilter;
     SoundHighPassFilter m_highPassFilter1;
@@ -145,6 +174,12 @@ private:
 
     bool m_inputStrobe {};
 
-    QVector<qint32> m_samples;
-    qint32 m_sampleRate { 44100 };
+    qint32 m_sampleRate {};
+    double m_sampleRateAdjustment { 1. };
+
+    std::vector<qint32> m_sampleBuffer; // size is always a power of 2
+    std::size_t m_sampleRead {}; // both positions only ever increase, masked when indexing
+    std::size_t m_sampleWrite {};
+    quint64 m_sampleOverruns {};
+    quint64 m_sampleUnderruns {};
 };
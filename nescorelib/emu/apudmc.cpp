@@ -1,12 +1,10 @@
 #include "apudmc.h"
 
-// Qt includes
-#include <QDataStream>
-
 // local includes
 #include "emusettings.h"
 #include "apu.h"
 #include "nesemulator.h"
+#include "snapshot.h"
 
 ApuDmc::ApuDmc(Apu &apu) :
     m_apu(apu)
@@ -197,21 +195,16 @@ void ApuDmc::apuDmcRead4015()
         m_apu.setRegIoDb((m_apu.regIoDb() & 0xEF) | 0x10);
 }
 
-void ApuDmc::apuDmcWriteState(QDataStream &dataStream) const
-{
-    dataStream << m_apuDmcOutputA << m_apuDmcOutput << m_apuDmcPeriodDevider << m_apuDmcIrqEnabled << m_apuDmcLoopFlag
-               << m_apuDmcRateIndex << m_apuDmcAddrRefresh << m_apuDmcSizeRefresh << m_apuDmcDmaEnabled << m_apuDmcDmaByte
-               << m_apuDmcDmaBits << m_apuDmcBufferFull << m_apuDmcDmaBuffer << m_apuDmcDmaSize << m_apuDmcDmaAddr;
-}
-
-void ApuDmc::apuDmcReadState(QDataStream &dataStream)
+void ApuDmc::apuDmcWriteState(SnapshotWriter &snapshot) const
 {
-    dataStream >> m_apuDmcOutputA >> m_apuDmcOutput >> m_apuDmcPeriodDevider >> m_apuDmcIrqEnabled >> m_apuDmcLoopFlag
-               >> m_apuDmcRateIndex >> m_apuDmcAddrRefresh >> m_apuDmcSizeRefresh >> m_apuDmcDmaEnabled >> m_apuDmcDmaByte
-               >> m_apuDmcDmaBits >> m_apuDmcBufferFull >> m_apuDmcDmaBuffer >> m_apuDmcDmaSize >> m_apuDmcDmaAddr;
+    snapshot << m_apuDmcOutputA << m_apuDmcOutput << m_apuDmcPeriodDevider << m_apuDmcIrqEnabled << m_apuDmcLoopFlag
+             << m_apuDmcRateIndex << m_apuDmcAddrRefresh << m_apuDmcSizeRefresh << m_apuDmcDmaEnabled << m_apuDmcDmaByte
+             << m_apuDmcDmaBits << m_apuDmcBufferFull << m_apuDmcDmaBuffer << m_apuDmcDmaSize << m_apuDmcDmaAddr;
 }
 
-qint32 ApuDmc::output() const
+void ApuDmc::apuDmcReadState(SnapshotReader &snapshot)
 {
-    return m_apuDmcOutput;
+    snapshot >> m_apuDmcOutputA >> m_apuDmcOutput >> m_apuDmcPeriodDevider >> m_apuDmcIrqEnabled >> m_apuDmcLoopFlag
+             >> m_apuDmcRateIndex >> m_apuDmcAddrRefresh >> m_apuDmcSizeRefresh >> m_apuDmcDmaEnabled >> m_apuDmcDmaByte
+             >> m_apuDmcDmaBits >> m_apuDmcBufferFull >> m_apuDmcDmaBuffer >> m_apuDmcDmaSize >> m_apuDmcDmaAddr;
 }
@@ -6,7 +6,8 @@
 #include <QtGlobal>
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 class Apu;
 
 class NESCORELIB_EXPORT ApuDmc
@@ -28,10 +29,11 @@ public:
     void apuDmcOn4015();
     void apuDmcRead4015();
 
-    void apuDmcWriteState(QDataStream &dataStream) const;
-    void apuDmcReadState(QDataStream &dataStream);
+    void apuDmcWriteState(SnapshotWriter &snapshot) const;
+    void apuDmcReadState(SnapshotReader &snapshot);
 
-    qint32 output() const;
+    // read by the mixer on every cycle
+    qint32 output() const { return m_apuDmcOutput; }
 
 private:
     Apu &m_apu;
@@ -1,11 +1,12 @@
 #include "apunos.h"
 
-// Qt includes
-#include <QDataStream>
+// system includes
+#include <algorithm>
 
 // local includes
 #include "emusettings.h"
 #include "apu.h"
+#include "snapshot.h"
 
 ApuNos::ApuNos(Apu &apu) :
     m_apu(apu)
@@ -37,12 +38,18 @@ void ApuNos::apuNosSoftReset()
     apuNosHardReset();
 }
 
-void ApuNos::apuNosClock()
+qint32 ApuNos::apuNosClocksUntilStep() const
 {
-    m_apuNosPeriodDevider--;
-    if (m_apuNosPeriodDevider > 0)
-        return;
+    return std::max(m_apuNosPeriodDevider, 1);
+}
+
+void ApuNos::apuNosSkip(qint32 clocks)
+{
+    m_apuNosPeriodDevider -= clocks;
+}
 
+void ApuNos::apuNosStep()
+{
     m_apuNosPeriodDevider = m_apuNosTimer;
 
     if (m_apuNosMode)
@@ -172,9 +179,9 @@ void ApuNos::apuNosRead4015()
         m_apu.setRegIoDb((m_apu.regIoDb() & 0xF7) | 0x08);
 }
 
-void ApuNos::apuNosWriteState(QDataStream &dataStream) const
+void ApuNos::apuNosWriteState(SnapshotWriter &snapshot) const
 {
-    dataStream
+    snapshot
             << m_apuNosLengthHalt
             << m_apuNosConstantVolumeEnvelope
             << m_apuNosVolumeDeviderPeriod
@@ -193,9 +200,9 @@ void ApuNos::apuNosWriteState(QDataStream &dataStream) const
             << m_apuNosIgnoreReload;
 }
 
-void ApuNos::apuNosReadState(QDataStream &dataStream)
+void ApuNos::apuNosReadState(SnapshotReader &snapshot)
 {
-    dataStream
+    snapshot
             >> m_apuNosLengthHalt
             >> m_apuNosConstantVolumeEnvelope
             >> m_apuNosVolumeDeviderPeriod
@@ -213,8 +220,3 @@ void ApuNos::apuNosReadState(QDataStream &dataStream)
             >> m_apuNosFeedback
             >> m_apuNosIgnoreReload;
 }
-
-qint32 ApuNos::output() const
-{
-    return m_apuNosOutput;
-}
@@ -6,7 +6,8 @@
 #include <QtGlobal>
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 class Apu;
 
 class NESCORELIB_EXPORT ApuNos
@@ -17,7 +18,11 @@ public:
     void apuNosHardReset();
     void apuNosSoftReset();
 
-    void apuNosClock();
+    // Driven by the apu on demand instead of every clock, the divider runs down by one per
+    // clock and the channel steps on the clock it reaches zero
+    qint32 apuNosClocksUntilStep() const;
+    void apuNosSkip(qint32 clocks);
+    void apuNosStep();
     void apuNosClockLength();
     void apuNosClockEnvelope();
 
@@ -29,10 +34,11 @@ public:
     void apuNosOn4015();
     void apuNosRead4015();
 
-    void apuNosWriteState(QDataStream &dataStream) const;
-    void apuNosReadState(QDataStream &dataStream);
+    void apuNosWriteState(SnapshotWriter &snapshot) const;
+    void apuNosReadState(SnapshotReader &snapshot);
 
-    qint32 output() const;
+    // read by the mixer on every change
+    qint32 output() const { return m_apuNosOutput; }
 
 private:
     Apu &m_apu;
@@ -1,11 +1,12 @@
 #include "apusq1.h"
 
-// Qt includes
-#include <QDataStream>
+// system includes
+#include <algorithm>
 
 // local includes
 #include "emusettings.h"
 #include "apu.h"
+#include "snapshot.h"
 
 ApuSq1::ApuSq1(Apu &apu) :
     m_apu(apu)
@@ -44,21 +45,27 @@ void ApuSq1::apuSq1SoftReset()
     apuSq1HardReset();
 }
 
-void ApuSq1::apuSq1Clock()
+qint32 ApuSq1::apuSq1ClocksUntilStep() const
 {
-    m_apuSq1PeriodDevider--;
-    if (m_apuSq1PeriodDevider <= 0)
+    return std::max(m_apuSq1PeriodDevider, 1);
+}
+
+void ApuSq1::apuSq1Skip(qint32 clocks)
+{
+    m_apuSq1PeriodDevider -= clocks;
+}
+
+void ApuSq1::apuSq1Step()
+{
+    m_apuSq1PeriodDevider = m_apuSq1Timer + 1;
+    m_apuSq1Seqencer = (m_apuSq1Seqencer + 1) & 0x7;
+    if (m_apuSq1LengthCounter > 0 && m_apuSq1ValidFreq)
     {
-        m_apuSq1PeriodDevider = m_apuSq1Timer + 1;
-        m_apuSq1Seqencer = (m_apuSq1Seqencer + 1) & 0x7;
-        if (m_apuSq1LengthCounter > 0 && m_apuSq1ValidFreq)
-        {
-            if (EmuSettings::Audio::ChannelEnabled::SQ1)
-                m_apuSq1Output = m_apu.m_sqDutyCycleSequences[m_apuSq1DutyCycle][m_apuSq1Seqencer] * m_apuSq1Envelope;
-        }
-        else
-            m_apuSq1Output = 0;
+        if (EmuSettings::Audio::ChannelEnabled::SQ1)
+            m_apuSq1Output = m_apu.m_sqDutyCycleSequences[m_apuSq1DutyCycle][m_apuSq1Seqencer] * m_apuSq1Envelope;
     }
+    else
+        m_apuSq1Output = 0;
 }
 
 void ApuSq1::apuSq1ClockLength()
@@ -195,25 +202,20 @@ void ApuSq1::apuSq1CalculateValidFreq()
     m_apuSq1ValidFreq = (m_apuSq1Timer >= 0x8) && ((m_apuSq1SweepNegate) || (((m_apuSq1Timer + (m_apuSq1Timer >> m_apuSq1SweepShiftCount)) & 0x800) == 0));
 }
 
-void ApuSq1::apuSq1WriteState(QDataStream &dataStream) const
-{
-    dataStream << m_apuSq1DutyCycle << m_apuSq1LengthHalt << m_apuSq1ConstantVolumeEnvelope << m_apuSq1VolumeDeviderPeriod
-               << m_apuSq1SweepEnable << m_apuSq1SweepDeviderPeriod << m_apuSq1SweepNegate << m_apuSq1SweepShiftCount << m_apuSq1Timer
-               << m_apuSq1PeriodDevider << m_apuSq1Seqencer << m_apuSq1LengthEnabled << m_apuSq1LengthCounter << m_apuSq1EnvelopeStartFlag
-               << m_apuSq1EnvelopeDevider << m_apuSq1EnvelopeDecayLevelCounter << m_apuSq1Envelope << m_apuSq1SweepCounter
-               << m_apuSq1SweepReload << m_apuSq1SweepChange << m_apuSq1ValidFreq << m_apuSq1Output << m_apuSq1IgnoreReload;
-}
-
-void ApuSq1::apuSq1ReadState(QDataStream &dataStream)
+void ApuSq1::apuSq1WriteState(SnapshotWriter &snapshot) const
 {
-    dataStream >> m_apuSq1DutyCycle >> m_apuSq1LengthHalt >> m_apuSq1ConstantVolumeEnvelope >> m_apuSq1VolumeDeviderPeriod
-               >> m_apuSq1SweepEnable >> m_apuSq1SweepDeviderPeriod >> m_apuSq1SweepNegate >> m_apuSq1SweepShiftCount >> m_apuSq1Timer
-               >> m_apuSq1PeriodDevider >> m_apuSq1Seqencer >> m_apuSq1LengthEnabled >> m_apuSq1LengthCounter >> m_apuSq1EnvelopeStartFlag
-               >> m_apuSq1EnvelopeDevider >> m_apuSq1EnvelopeDecayLevelCounter >> m_apuSq1Envelope >> m_apuSq1SweepCounter
-               >> m_apuSq1SweepReload >> m_apuSq1SweepChange >> m_apuSq1ValidFreq >> m_apuSq1Output >> m_apuSq1IgnoreReload;
+    snapshot << m_apuSq1DutyCycle << m_apuSq1LengthHalt << m_apuSq1ConstantVolumeEnvelope << m_apuSq1VolumeDeviderPeriod
+             << m_apuSq1SweepEnable << m_apuSq1SweepDeviderPeriod << m_apuSq1SweepNegate << m_apuSq1SweepShiftCount << m_apuSq1Timer
+             << m_apuSq1PeriodDevider << m_apuSq1Seqencer << m_apuSq1LengthEnabled << m_apuSq1LengthCounter << m_apuSq1EnvelopeStartFlag
+             << m_apuSq1EnvelopeDevider << m_apuSq1EnvelopeDecayLevelCounter << m_apuSq1Envelope << m_apuSq1SweepCounter
+             << m_apuSq1SweepReload << m_apuSq1SweepChange << m_apuSq1ValidFreq << m_apuSq1Output << m_apuSq1IgnoreReload;
 }
 
-qint32 ApuSq1::output() const
+void ApuSq1::apuSq1ReadState(SnapshotReader &snapshot)
 {
-    return m_apuSq1Output;
+    snapshot >> m_apuSq1DutyCycle >> m_apuSq1LengthHalt >> m_apuSq1ConstantVolumeEnvelope >> m_apuSq1VolumeDeviderPeriod
+             >> m_apuSq1SweepEnable >> m_apuSq1SweepDeviderPeriod >> m_apuSq1SweepNegate >> m_apuSq1SweepShiftCount >> m_apuSq1Timer
+             >> m_apuSq1PeriodDevider >> m_apuSq1Seqencer >> m_apuSq1LengthEnabled >> m_apuSq1LengthCounter >> m_apuSq1EnvelopeStartFlag
+             >> m_apuSq1EnvelopeDevider >> m_apuSq1EnvelopeDecayLevelCounter >> m_apuSq1Envelope >> m_apuSq1SweepCounter
+             >> m_apuSq1SweepReload >> m_apuSq1SweepChange >> m_apuSq1ValidFreq >> m_apuSq1Output >> m_apuSq1IgnoreReload;
 }
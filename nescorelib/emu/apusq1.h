@@ -6,7 +6,8 @@
 #include <QtGlobal>
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 class Apu;
 
 class NESCORELIB_EXPORT ApuSq1
@@ -17,7 +18,11 @@ public:
     void apuSq1HardReset();
     void apuSq1SoftReset();
 
-    void apuSq1Clock();
+    // Driven by the apu on demand instead of every clock, the divider runs down by one per
+    // clock and the channel steps on the clock it reaches zero
+    qint32 apuSq1ClocksUntilStep() const;
+    void apuSq1Skip(qint32 clocks);
+    void apuSq1Step();
     void apuSq1ClockLength();
     void apuSq1ClockEnvelope();
 
@@ -31,10 +36,11 @@ public:
 
     void apuSq1CalculateValidFreq();
 
-    void apuSq1WriteState(QDataStream &dataStream) const;
-    void apuSq1ReadState(QDataStream &dataStream);
+    void apuSq1WriteState(SnapshotWriter &snapshot) const;
+    void apuSq1ReadState(SnapshotReader &snapshot);
 
-    qint32 output() const;
+    // read by the mixer on every change
+    qint32 output() const { return m_apuSq1Output; }
 
 private:
     Apu &m_apu;
@@ -1,11 +1,12 @@
 #include "apusq2.h"
 
-// Qt includes
-#include <QDataStream>
+// system includes
+#include <algorithm>
 
 // local includes
 #include "emusettings.h"
 #include "apu.h"
+#include "snapshot.h"
 
 ApuSq2::ApuSq2(Apu &apu) :
     m_apu(apu)
@@ -44,21 +45,27 @@ void ApuSq2::apuSq2SoftReset()
     apuSq2HardReset();
 }
 
-void ApuSq2::apuSq2Clock()
+qint32 ApuSq2::apuSq2ClocksUntilStep() const
 {
-    m_apuSq2PeriodDevider--;
-    if (m_apuSq2PeriodDevider <= 0)
+    return std::max(m_apuSq2PeriodDevider, 1);
+}
+
+void ApuSq2::apuSq2Skip(qint32 clocks)
+{
+    m_apuSq2PeriodDevider -= clocks;
+}
+
+void ApuSq2::apuSq2Step()
+{
+    m_apuSq2PeriodDevider = m_apuSq2Timer + 1;
+    m_apuSq2Seqencer = (m_apuSq2Seqencer + 1) & 0x7;
+    if (m_apuSq2LengthCounter > 0 && m_apuSq2ValidFreq)
     {
-        m_apuSq2PeriodDevider = m_apuSq2Timer + 1;
-        m_apuSq2Seqencer = (m_apuSq2Seqencer + 1) & 0x7;
-        if (m_apuSq2LengthCounter > 0 && m_apuSq2ValidFreq)
-        {
-            if (EmuSettings::Audio::ChannelEnabled::SQ2)
-                m_apuSq2Output = m_apu.m_sqDutyCycleSequences[m_apuSq2DutyCycle][m_apuSq2Seqencer] * m_apuSq2Envelope;
-        }
-        else
-            m_apuSq2Output = 0;
+        if (EmuSettings::Audio::ChannelEnabled::SQ2)
+            m_apuSq2Output = m_apu.m_sqDutyCycleSequences[m_apuSq2DutyCycle][m_apuSq2Seqencer] * m_apuSq2Envelope;
     }
+    else
+        m_apuSq2Output = 0;
 }
 
 void ApuSq2::apuSq2ClockLength()
@@ -192,25 +199,20 @@ void ApuSq2::apuSq2CalculateValidFreq()
     m_apuSq2ValidFreq = (m_apuSq2Timer >= 0x8) && ((m_apuSq2SweepNegate) || (((m_apuSq2Timer + (m_apuSq2Timer >> m_apuSq2SweepShiftCount)) & 0x800) == 0));
 }
 
-void ApuSq2::apuSq2WriteState(QDataStream &dataStream) const
+void ApuSq2::apuSq2WriteState(SnapshotWriter &snapshot) const
 {
-    dataStream
+    snapshot
             << m_apuSq2DutyCycle << m_apuSq2LengthHalt << m_apuSq2ConstantVolumeEnvelope << m_apuSq2VolumeDeviderPeriod << m_apuSq2SweepEnable
             << m_apuSq2SweepDeviderPeriod << m_apuSq2SweepNegate << m_apuSq2SweepShiftCount << m_apuSq2Timer << m_apuSq2PeriodDevider << m_apuSq2Seqencer
             << m_apuSq2LengthEnabled << m_apuSq2LengthCounter << m_apuSq2EnvelopeStartFlag << m_apuSq2EnvelopeDevider << m_apuSq2EnvelopeDecayLevelCounter
             << m_apuSq2Envelope << m_apuSq2SweepCounter << m_apuSq2SweepReload << m_apuSq2SweepChange << m_apuSq2ValidFreq << m_apuSq2Output << m_apuSq2IgnoreReload;
 }
 
-void ApuSq2::apuSq2ReadState(QDataStream &dataStream)
+void ApuSq2::apuSq2ReadState(SnapshotReader &snapshot)
 {
-    dataStream
+    snapshot
             >> m_apuSq2DutyCycle >> m_apuSq2LengthHalt >> m_apuSq2ConstantVolumeEnvelope >> m_apuSq2VolumeDeviderPeriod >> m_apuSq2SweepEnable
             >> m_apuSq2SweepDeviderPeriod >> m_apuSq2SweepNegate >> m_apuSq2SweepShiftCount >> m_apuSq2Timer >> m_apuSq2PeriodDevider >> m_apuSq2Seqencer
             >> m_apuSq2LengthEnabled >> m_apuSq2LengthCounter >> m_apuSq2EnvelopeStartFlag >> m_apuSq2EnvelopeDevider >> m_apuSq2EnvelopeDecayLevelCounter
             >> m_apuSq2Envelope >> m_apuSq2SweepCounter >> m_apuSq2SweepReload >> m_apuSq2SweepChange >> m_apuSq2ValidFreq >> m_apuSq2Output >> m_apuSq2IgnoreReload;
 }
-
-qint32 ApuSq2::output() const
-{
-    return m_apuSq2Output;
-}
@@ -6,7 +6,8 @@
 #include <QtGlobal>
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 class Apu;
 
 class NESCORELIB_EXPORT ApuSq2
@@ -17,7 +18,11 @@ public:
     void apuSq2HardReset();
     void apuSq2SoftReset();
 
-    void apuSq2Clock();
+    // Driven by the apu on demand instead of every clock, the divider runs down by one per
+    // clock and the channel steps on the clock it reaches zero
+    qint32 apuSq2ClocksUntilStep() const;
+    void apuSq2Skip(qint32 clocks);
+    void apuSq2Step();
     void apuSq2ClockLength();
     void apuSq2ClockEnvelope();
 
@@ -31,10 +36,11 @@ public:
 
     void apuSq2CalculateValidFreq();
 
-    void apuSq2WriteState(QDataStream &dataStream) const;
-    void apuSq2ReadState(QDataStream &dataStream);
+    void apuSq2WriteState(SnapshotWriter &snapshot) const;
+    void apuSq2ReadState(SnapshotReader &snapshot);
 
-    qint32 output() const;
+    // read by the mixer on every change
+    qint32 output() const { return m_apuSq2Output; }
 
 private:
     Apu &m_apu;
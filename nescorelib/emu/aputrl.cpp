@@ -1,11 +1,12 @@
 #include "aputrl.h"
 
-// Qt includes
-#include <QDataStream>
+// system includes
+#include <algorithm>
 
 // local includes
 #include "emusettings.h"
 #include "apu.h"
+#include "snapshot.h"
 
 ApuTrl::ApuTrl(Apu &apu) :
     m_apu(apu)
@@ -32,27 +33,33 @@ void ApuTrl::apuTrlSoftReset()
     apuTrlHardReset();
 }
 
-void ApuTrl::apuTrlClock()
+qint32 ApuTrl::apuTrlClocksUntilStep() const
+{
+    return std::max(m_apuTrlPeriodDevider, 1);
+}
+
+void ApuTrl::apuTrlSkip(qint32 clocks)
+{
+    m_apuTrlPeriodDevider -= clocks;
+}
+
+void ApuTrl::apuTrlStep()
 {
     static constexpr std::array<quint8, 32> stepSeq {
         15, 14, 13, 12, 11, 10,  9,  8,  7,  6,  5,  4,  3,  2,  1,  0,
         0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15
     };
 
-    m_apuTrlPeriodDevider--;
-    if (m_apuTrlPeriodDevider <= 0)
-    {
-        m_apuTrlPeriodDevider = m_apuTrlTimer + 1;
+    m_apuTrlPeriodDevider = m_apuTrlTimer + 1;
 
-        if (m_apuTrlLengthCounter > 0 && m_apuTrlLinerCounter > 0)
+    if (m_apuTrlLengthCounter > 0 && m_apuTrlLinerCounter > 0)
+    {
+        if (m_apuTrlTimer >= 4)
         {
-            if (m_apuTrlTimer >= 4)
-            {
-                m_apuTrlStep++;
-                m_apuTrlStep &= 0x1F;
-                if (EmuSettings::Audio::ChannelEnabled::TRL)
-                    m_apuTrlOutput = stepSeq[m_apuTrlStep];
-            }
+            m_apuTrlStep++;
+            m_apuTrlStep &= 0x1F;
+            if (EmuSettings::Audio::ChannelEnabled::TRL)
+                m_apuTrlOutput = stepSeq[m_apuTrlStep];
         }
     }
 }
@@ -136,9 +143,9 @@ void ApuTrl::apuTrlRead4015()
         m_apu.setRegIoDb((m_apu.regIoDb() & 0xFB) | 0x04);
 }
 
-void ApuTrl::apuTrlWriteState(QDataStream &dataStream) const
+void ApuTrl::apuTrlWriteState(SnapshotWriter &snapshot) const
 {
-    dataStream
+    snapshot
             << m_apuTrlLinerControlFlag
             << m_apuTrlLinerControlReload
             << m_apuTrlTimer
@@ -152,9 +159,9 @@ void ApuTrl::apuTrlWriteState(QDataStream &dataStream) const
             << m_apuTrlIgnoreReload;
 }
 
-void ApuTrl::apuTrlReadState(QDataStream &dataStream)
+void ApuTrl::apuTrlReadState(SnapshotReader &snapshot)
 {
-    dataStream
+    snapshot
             >> m_apuTrlLinerControlFlag
             >> m_apuTrlLinerControlReload
             >> m_apuTrlTimer
@@ -167,8 +174,3 @@ void ApuTrl::apuTrlReadState(QDataStream &dataStream)
             >> m_apuTrlStep
             >> m_apuTrlIgnoreReload;
 }
-
-qint32 ApuTrl::output() const
-{
-    return m_apuTrlOutput;
-}
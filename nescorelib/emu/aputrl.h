@@ -6,7 +6,8 @@
 #include <QtGlobal>
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 class Apu;
 
 class NESCORELIB_EXPORT ApuTrl
@@ -17,7 +18,11 @@ public:
     void apuTrlHardReset();
     void apuTrlSoftReset();
 
-    void apuTrlClock();
+    // Driven by the apu on demand instead of every clock, the divider runs down by one per
+    // clock and the channel steps on the clock it reaches zero
+    qint32 apuTrlClocksUntilStep() const;
+    void apuTrlSkip(qint32 clocks);
+    void apuTrlStep();
     void apuTrlClockLength();
     void apuTrlClockEnvelope();
 
@@ -29,10 +34,11 @@ public:
     void apuTrlOn4015();
     void apuTrlRead4015();
 
-    void apuTrlWriteState(QDataStream &dataStream) const;
-    void apuTrlReadState(QDataStream &dataStream);
+    void apuTrlWriteState(SnapshotWriter &snapshot) const;
+    void apuTrlReadState(SnapshotReader &snapshot);
 
-    qint32 output() const;
+    // read by the mixer on every change
+    qint32 output() const { return m_apuTrlOutput; }
 
 private:
     Apu &m_apu;
@@ -1,13 +1,16 @@
 #include "cpu.h"
 
-// Qt includes
-#include <QDataStream>
-
 // local includes
 #include "nesemulator.h"
+#include "snapshot.h"
 
 Cpu::Cpu(NesEmulator &emu) :
-    m_emu(emu)
+    m_emu(emu),
+#ifdef NESCORE_FUSED_CPU
+    m_dispatch(Dispatch::Fused)
+#else
+    m_dispatch(Dispatch::Table)
+#endif
 {
 }
 
@@ -41,87 +44,208 @@ quint8 Cpu::getRegisterPb() const
            (m_flagC ? 0x01 : 0) | 0x30;
 }
 
+constexpr std::array<void (Cpu::*)(), 256> Cpu::cpuAddressings {
+//           0x0,           0x1,           0x2,           0x3,           0x4,           0x5,           0x6,           0x7
+//           0x8,           0x9,           0xA,           0xB,           0xC,           0xD,           0xE,           0xF
+/*0x0*/&Cpu::imp____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x0
+/*0x1*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
+       &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x1
+/*0x2*/&Cpu::imp____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x2
+/*0x3*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
+       &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x3
+/*0x4*/&Cpu::imA____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_w__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x4
+/*0x5*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
+       &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x5
+/*0x6*/&Cpu::imA____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::imp____, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x6
+/*0x7*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
+       &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x7
+/*0x8*/&Cpu::imm____, &Cpu::indX_w_, &Cpu::imm____, &Cpu::indX_w_, &Cpu::zpg_w__, &Cpu::zpg_w__, &Cpu::zpg_w__, &Cpu::zpg_w__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_w__, &Cpu::abs_w__, &Cpu::abs_w__, &Cpu::abs_w__, // 0x8
+/*0x9*/&Cpu::imp____, &Cpu::indY_w_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_w_, &Cpu::zpgX_w_, &Cpu::zpgY_w_, &Cpu::zpgY_w_,
+       &Cpu::imA____, &Cpu::absY_w_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::abs_w__, &Cpu::absX_w_, &Cpu::abs_w__, &Cpu::absY_w_, // 0x9
+/*0xA*/&Cpu::imm____, &Cpu::indX_r_, &Cpu::imm____, &Cpu::indX_r_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_r__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_r__, // 0xA
+/*0xB*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_r_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgY_r_, &Cpu::zpgY_r_,
+       &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_r_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absY_r_, &Cpu::absY_r_, // 0xB
+/*0xC*/&Cpu::imm____, &Cpu::indX_r_, &Cpu::imm____, &Cpu::indX_r_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_r__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_r__, // 0xC
+/*0xD*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_rw, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_rw,
+       &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_rw, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_rw, // 0xD
+/*0xE*/&Cpu::imm____, &Cpu::indX_r_, &Cpu::imm____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
+       &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0xE
+/*0xF*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
+       &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0xF
+};
+
+constexpr std::array<void (Cpu::*)(), 256> Cpu::cpuInstructions {
+//           0x0,         0x1,         0x2,         0x3,         0x4,         0x5,         0x6,         0x7
+//           0x8,         0x9,         0xA,         0xB,         0xC,         0xD,         0xE,         0xF
+/*0x0*/&Cpu::brk__, &Cpu::ora__, &Cpu::nop__, &Cpu::slo__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__,
+       &Cpu::php__, &Cpu::ora__, &Cpu::asl_a, &Cpu::anc__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__, // 0x0
+/*0x1*/&Cpu::bpl__, &Cpu::ora__, &Cpu::nop__, &Cpu::slo__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__,
+       &Cpu::clc__, &Cpu::ora__, &Cpu::nop__, &Cpu::slo__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__, // 0x1
+/*0x2*/&Cpu::jsr__, &Cpu::and__, &Cpu::nop__, &Cpu::rla__, &Cpu::bit__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__,
+       &Cpu::plp__, &Cpu::and__, &Cpu::rol_a, &Cpu::anc__, &Cpu::bit__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__, // 0x2
+/*0x3*/&Cpu::bmi__, &Cpu::and__, &Cpu::nop__, &Cpu::rla__, &Cpu::nop__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__,
+       &Cpu::sec__, &Cpu::and__, &Cpu::nop__, &Cpu::rla__, &Cpu::nop__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__, // 0x3
+/*0x4*/&Cpu::rti__, &Cpu::eor__, &Cpu::nop__, &Cpu::sre__, &Cpu::nop__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__,
+       &Cpu::pha__, &Cpu::eor__, &Cpu::lsr_a, &Cpu::alr__, &Cpu::jmp__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__, // 0x4
+/*0x5*/&Cpu::bvm__, &Cpu::eor__, &Cpu::nop__, &Cpu::sre__, &Cpu::nop__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__,
+       &Cpu::cli__, &Cpu::eor__, &Cpu::nop__, &Cpu::sre__, &Cpu::nop__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__, // 0x5
+/*0x6*/&Cpu::rts__, &Cpu::adc__, &Cpu::nop__, &Cpu::rra__, &Cpu::nop__, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__,
+       &Cpu::pla__, &Cpu::adc__, &Cpu::ror_a, &Cpu::arr__, &Cpu::jmp_i, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__, // 0x6
+/*0x7*/&Cpu::bvs__, &Cpu::adc__, &Cpu::nop__, &Cpu::rra__, &Cpu::nop__, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__,
+       &Cpu::sei__, &Cpu::adc__, &Cpu::nop__, &Cpu::rra__, &Cpu::nop__, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__, // 0x7
+/*0x8*/&Cpu::nop__, &Cpu::sta__, &Cpu::nop__, &Cpu::sax__, &Cpu::sty__, &Cpu::sta__, &Cpu::stx__, &Cpu::sax__,
+       &Cpu::dey__, &Cpu::nop__, &Cpu::txa__, &Cpu::xaa__, &Cpu::sty__, &Cpu::sta__, &Cpu::stx__, &Cpu::sax__, // 0x8
+/*0x9*/&Cpu::bcc__, &Cpu::sta__, &Cpu::nop__, &Cpu::ahc__, &Cpu::sty__, &Cpu::sta__, &Cpu::stx__, &Cpu::sax__,
+       &Cpu::tya__, &Cpu::sta__, &Cpu::txs__, &Cpu::xas__, &Cpu::shy__, &Cpu::sta__, &Cpu::shx__, &Cpu::ahc__, // 0x9
+/*0xA*/&Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__,
+       &Cpu::tay__, &Cpu::lda__, &Cpu::tax__, &Cpu::lax__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__, // 0xA
+/*0xB*/&Cpu::bcs__, &Cpu::lda__, &Cpu::nop__, &Cpu::lax__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__,
+       &Cpu::clv__, &Cpu::lda__, &Cpu::tsx__, &Cpu::lar__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__, // 0xB
+/*0xC*/&Cpu::cpy__, &Cpu::cmp__, &Cpu::nop__, &Cpu::dcp__, &Cpu::cpy__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__,
+       &Cpu::iny__, &Cpu::cmp__, &Cpu::dex__, &Cpu::axs__, &Cpu::cpy__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__, // 0xC
+/*0xD*/&Cpu::bne__, &Cpu::cmp__, &Cpu::nop__, &Cpu::dcp__, &Cpu::nop__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__,
+       &Cpu::cld__, &Cpu::cmp__, &Cpu::nop__, &Cpu::dcp__, &Cpu::nop__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__, // 0xD
+/*0xE*/&Cpu::cpx__, &Cpu::sdc__, &Cpu::nop__, &Cpu::isc__, &Cpu::cpx__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__,
+       &Cpu::inx__, &Cpu::sdc__, &Cpu::nop__, &Cpu::sdc__, &Cpu::cpx__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__, // 0xE
+/*0xF*/&Cpu::beq__, &Cpu::sdc__, &Cpu::nop__, &Cpu::isc__, &Cpu::nop__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__,
+       &Cpu::sed__, &Cpu::sdc__, &Cpu::nop__, &Cpu::isc__, &Cpu::nop__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__, // 0xF
+};
+
+namespace {
+// handler names for the opcode histogram
+constexpr std::array<const char *, 256> addressingNames {
+//     0x0,       0x1,       0x2,       0x3,       0x4,       0x5,       0x6,       0x7,
+//     0x8,       0x9,       0xA,       0xB,       0xC,       0xD,       0xE,       0xF,
+/*0x0*/"imp",     "indX_r",  "imA",     "indX_w",  "zpg_r",   "zpg_r",   "zpg_rw",  "zpg_w",
+       "imA",     "imm",     "imA",     "imm",     "abs_r",   "abs_r",   "abs_rw",  "abs_w", // 0x0
+/*0x1*/"imp",     "indY_r",  "imp",     "indY_w",  "zpgX_r",  "zpgX_r",  "zpgX_rw", "zpgX_w",
+       "imA",     "absY_r",  "imA",     "absY_w",  "absX_r",  "absX_r",  "absX_rw", "absX_w", // 0x1
+/*0x2*/"imp",     "indX_r",  "imA",     "indX_w",  "zpg_r",   "zpg_r",   "zpg_rw",  "zpg_w",
+       "imA",     "imm",     "imA",     "imm",     "abs_r",   "abs_r",   "abs_rw",  "abs_w", // 0x2
+/*0x3*/"imp",     "indY_r",  "imp",     "indY_w",  "zpgX_r",  "zpgX_r",  "zpgX_rw", "zpgX_w",
+       "imA",     "absY_r",  "imA",     "absY_w",  "absX_r",  "absX_r",  "absX_rw", "absX_w", // 0x3
+/*0x4*/"imA",     "indX_r",  "imA",     "indX_w",  "zpg_r",   "zpg_r",   "zpg_rw",  "zpg_w",
+       "imA",     "imm",     "imA",     "imm",     "abs_w",   "abs_r",   "abs_rw",  "abs_w", // 0x4
+/*0x5*/"imp",     "indY_r",  "imp",     "indY_w",  "zpgX_r",  "zpgX_r",  "zpgX_rw", "zpgX_w",
+       "imA",     "absY_r",  "imA",     "absY_w",  "absX_r",  "absX_r",  "absX_rw", "absX_w", // 0x5
+/*0x6*/"imA",     "indX_r",  "imA",     "indX_w",  "zpg_r",   "zpg_r",   "zpg_rw",  "zpg_w",
+       "imA",     "imm",     "imA",     "imm",     "imp",     "abs_r",   "abs_rw",  "abs_w", // 0x6
+/*0x7*/"imp",     "indY_r",  "imp",     "indY_w",  "zpgX_r",  "zpgX_r",  "zpgX_rw", "zpgX_w",
+       "imA",     "absY_r",  "imA",     "absY_w",  "absX_r",  "absX_r",  "absX_rw", "absX_w", // 0x7
+/*0x8*/"imm",     "indX_w",  "imm",     "indX_w",  "zpg_w",   "zpg_w",   "zpg_w",   "zpg_w",
+       "imA",     "imm",     "imA",     "imm",     "abs_w",   "abs_w",   "abs_w",   "abs_w", // 0x8
+/*0x9*/"imp",     "indY_w",  "imp",     "indY_w",  "zpgX_w",  "zpgX_w",  "zpgY_w",  "zpgY_w",
+       "imA",     "absY_w",  "imA",     "absY_w",  "abs_w",   "absX_w",  "abs_w",   "absY_w", // 0x9
+/*0xA*/"imm",     "indX_r",  "imm",     "indX_r",  "zpg_r",   "zpg_r",   "zpg_r",   "zpg_r",
+       "imA",     "imm",     "imA",     "imm",     "abs_r",   "abs_r",   "abs_r",   "abs_r", // 0xA
+/*0xB*/"imp",     "indY_r",  "imp",     "indY_r",  "zpgX_r",  "zpgX_r",  "zpgY_r",  "zpgY_r",
+       "imA",     "absY_r",  "imA",     "absY_r",  "absX_r",  "absX_r",  "absY_r",  "absY_r", // 0xB
+/*0xC*/"imm",     "indX_r",  "imm",     "indX_r",  "zpg_r",   "zpg_r",   "zpg_rw",  "zpg_r",
+       "imA",     "imm",     "imA",     "imm",     "abs_r",   "abs_r",   "abs_rw",  "abs_r", // 0xC
+/*0xD*/"imp",     "indY_r",  "imp",     "indY_rw", "zpgX_r",  "zpgX_r",  "zpgX_rw", "zpgX_rw",
+       "imA",     "absY_r",  "imA",     "absY_rw", "absX_r",  "absX_r",  "absX_rw", "absX_rw", // 0xD
+/*0xE*/"imm",     "indX_r",  "imm",     "indX_w",  "zpg_r",   "zpg_r",   "zpg_rw",  "zpg_w",
+       "imA",     "imm",     "imA",     "imm",     "abs_r",   "abs_r",   "abs_rw",  "abs_w", // 0xE
+/*0xF*/"imp",     "indY_r",  "imp",     "indY_w",  "zpgX_r",  "zpgX_r",  "zpgX_rw", "zpgX_w",
+       "imA",     "absY_r",  "imA",     "absY_w",  "absX_r",  "absX_r",  "absX_rw", "absX_w", // 0xF
+};
+
+constexpr std::array<const char *, 256> instructionNames {
+//     0x0,      0x1,      0x2,      0x3,      0x4,      0x5,      0x6,      0x7,
+//     0x8,      0x9,      0xA,      0xB,      0xC,      0xD,      0xE,      0xF,
+/*0x0*/"brk",    "ora",    "nop",    "slo",    "nop",    "ora",    "asl_m",  "slo",
+       "php",    "ora",    "asl_a",  "anc",    "nop",    "ora",    "asl_m",  "slo", // 0x0
+/*0x1*/"bpl",    "ora",    "nop",    "slo",    "nop",    "ora",    "asl_m",  "slo",
+       "clc",    "ora",    "nop",    "slo",    "nop",    "ora",    "asl_m",  "slo", // 0x1
+/*0x2*/"jsr",    "and",    "nop",    "rla",    "bit",    "and",    "rol_m",  "rla",
+       "plp",    "and",    "rol_a",  "anc",    "bit",    "and",    "rol_m",  "rla", // 0x2
+/*0x3*/"bmi",    "and",    "nop",    "rla",    "nop",    "and",    "rol_m",  "rla",
+       "sec",    "and",    "nop",    "rla",    "nop",    "and",    "rol_m",  "rla", // 0x3
+/*0x4*/"rti",    "eor",    "nop",    "sre",    "nop",    "eor",    "lsr_m",  "sre",
+       "pha",    "eor",    "lsr_a",  "alr",    "jmp",    "eor",    "lsr_m",  "sre", // 0x4
+/*0x5*/"bvm",    "eor",    "nop",    "sre",    "nop",    "eor",    "lsr_m",  "sre",
+       "cli",    "eor",    "nop",    "sre",    "nop",    "eor",    "lsr_m",  "sre", // 0x5
+/*0x6*/"rts",    "adc",    "nop",    "rra",    "nop",    "adc",    "ror_m",  "rra",
+       "pla",    "adc",    "ror_a",  "arr",    "jmp_i",  "adc",    "ror_m",  "rra", // 0x6
+/*0x7*/"bvs",    "adc",    "nop",    "rra",    "nop",    "adc",    "ror_m",  "rra",
+       "sei",    "adc",    "nop",    "rra",    "nop",    "adc",    "ror_m",  "rra", // 0x7
+/*0x8*/"nop",    "sta",    "nop",    "sax",    "sty",    "sta",    "stx",    "sax",
+       "dey",    "nop",    "txa",    "xaa",    "sty",    "sta",    "stx",    "sax", // 0x8
+/*0x9*/"bcc",    "sta",    "nop",    "ahc",    "sty",    "sta",    "stx",    "sax",
+       "tya",    "sta",    "txs",    "xas",    "shy",    "sta",    "shx",    "ahc", // 0x9
+/*0xA*/"ldy",    "lda",    "ldx",    "lax",    "ldy",    "lda",    "ldx",    "lax",
+       "tay",    "lda",    "tax",    "lax",    "ldy",    "lda",    "ldx",    "lax", // 0xA
+/*0xB*/"bcs",    "lda",    "nop",    "lax",    "ldy",    "lda",    "ldx",    "lax",
+       "clv",    "lda",    "tsx",    "lar",    "ldy",    "lda",    "ldx",    "lax", // 0xB
+/*0xC*/"cpy",    "cmp",    "nop",    "dcp",    "cpy",    "cmp",    "dec",    "dcp",
+       "iny",    "cmp",    "dex",    "axs",    "cpy",    "cmp",    "dec",    "dcp", // 0xC
+/*0xD*/"bne",    "cmp",    "nop",    "dcp",    "nop",    "cmp",    "dec",    "dcp",
+       "cld",    "cmp",    "nop",    "dcp",    "nop",    "cmp",    "dec",    "dcp", // 0xD
+/*0xE*/"cpx",    "sdc",    "nop",    "isc",    "cpx",    "sdc",    "inc",    "isc",
+       "inx",    "sdc",    "nop",    "sdc",    "cpx",    "sdc",    "inc",    "isc", // 0xE
+/*0xF*/"beq",    "sdc",    "nop",    "isc",    "nop",    "sdc",    "inc",    "isc",
+       "sed",    "sdc",    "nop",    "isc",    "nop",    "sdc",    "inc",    "isc", // 0xF
+};
+}
+
+template<quint8 opcode>
+void Cpu::fused()
+{
+    // both pointers are compile time constants here, so the addressing mode
+    // and the instruction get called directly and can be inlined into one
+    // handler per opcode
+    constexpr auto addressing = cpuAddressings[opcode];
+    constexpr auto instruction = cpuInstructions[opcode];
+
+    (this->*addressing)();
+    (this->*instruction)();
+}
+
+template<std::size_t ...opcodes>
+constexpr std::array<void (Cpu::*)(), 256> Cpu::makeFusedHandlers(std::index_sequence<opcodes...>)
+{
+    return { &Cpu::fused<opcodes>... };
+}
+
+constexpr std::array<void (Cpu::*)(), 256> Cpu::cpuFusedHandlers = Cpu::makeFusedHandlers(std::make_index_sequence<256>());
+
 void Cpu::clock()
 {
-    static constexpr std::array<void (Cpu::*)(), 256> cpuAddressings {
-    //           0x0,           0x1,           0x2,           0x3,           0x4,           0x5,           0x6,           0x7
-    //           0x8,           0x9,           0xA,           0xB,           0xC,           0xD,           0xE,           0xF
-    /*0x0*/&Cpu::imp____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x0
-    /*0x1*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
-           &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x1
-    /*0x2*/&Cpu::imp____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x2
-    /*0x3*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
-           &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x3
-    /*0x4*/&Cpu::imA____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_w__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x4
-    /*0x5*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
-           &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x5
-    /*0x6*/&Cpu::imA____, &Cpu::indX_r_, &Cpu::imA____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::imp____, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0x6
-    /*0x7*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
-           &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0x7
-    /*0x8*/&Cpu::imm____, &Cpu::indX_w_, &Cpu::imm____, &Cpu::indX_w_, &Cpu::zpg_w__, &Cpu::zpg_w__, &Cpu::zpg_w__, &Cpu::zpg_w__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_w__, &Cpu::abs_w__, &Cpu::abs_w__, &Cpu::abs_w__, // 0x8
-    /*0x9*/&Cpu::imp____, &Cpu::indY_w_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_w_, &Cpu::zpgX_w_, &Cpu::zpgY_w_, &Cpu::zpgY_w_,
-           &Cpu::imA____, &Cpu::absY_w_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::abs_w__, &Cpu::absX_w_, &Cpu::abs_w__, &Cpu::absY_w_, // 0x9
-    /*0xA*/&Cpu::imm____, &Cpu::indX_r_, &Cpu::imm____, &Cpu::indX_r_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_r__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_r__, // 0xA
-    /*0xB*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_r_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgY_r_, &Cpu::zpgY_r_,
-           &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_r_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absY_r_, &Cpu::absY_r_, // 0xB
-    /*0xC*/&Cpu::imm____, &Cpu::indX_r_, &Cpu::imm____, &Cpu::indX_r_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_r__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_r__, // 0xC
-    /*0xD*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_rw, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_rw,
-           &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_rw, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_rw, // 0xD
-    /*0xE*/&Cpu::imm____, &Cpu::indX_r_, &Cpu::imm____, &Cpu::indX_w_, &Cpu::zpg_r__, &Cpu::zpg_r__, &Cpu::zpg_rw_, &Cpu::zpg_w__,
-           &Cpu::imA____, &Cpu::imm____, &Cpu::imA____, &Cpu::imm____, &Cpu::abs_r__, &Cpu::abs_r__, &Cpu::abs_rw_, &Cpu::abs_w__, // 0xE
-    /*0xF*/&Cpu::imp____, &Cpu::indY_r_, &Cpu::imp____, &Cpu::indY_w_, &Cpu::zpgX_r_, &Cpu::zpgX_r_, &Cpu::zpgX_rw, &Cpu::zpgX_w_,
-           &Cpu::imA____, &Cpu::absY_r_, &Cpu::imA____, &Cpu::absY_w_, &Cpu::absX_r_, &Cpu::absX_r_, &Cpu::absX_rw, &Cpu::absX_w_, // 0xF
-    };
-
-    static constexpr std::array<void (Cpu::*)(), 256> cpuInstructions {
-    //           0x0,         0x1,         0x2,         0x3,         0x4,         0x5,         0x6,         0x7
-    //           0x8,         0x9,         0xA,         0xB,         0xC,         0xD,         0xE,         0xF
-    /*0x0*/&Cpu::brk__, &Cpu::ora__, &Cpu::nop__, &Cpu::slo__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__,
-           &Cpu::php__, &Cpu::ora__, &Cpu::asl_a, &Cpu::anc__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__, // 0x0
-    /*0x1*/&Cpu::bpl__, &Cpu::ora__, &Cpu::nop__, &Cpu::slo__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__,
-           &Cpu::clc__, &Cpu::ora__, &Cpu::nop__, &Cpu::slo__, &Cpu::nop__, &Cpu::ora__, &Cpu::asl_m, &Cpu::slo__, // 0x1
-    /*0x2*/&Cpu::jsr__, &Cpu::and__, &Cpu::nop__, &Cpu::rla__, &Cpu::bit__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__,
-           &Cpu::plp__, &Cpu::and__, &Cpu::rol_a, &Cpu::anc__, &Cpu::bit__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__, // 0x2
-    /*0x3*/&Cpu::bmi__, &Cpu::and__, &Cpu::nop__, &Cpu::rla__, &Cpu::nop__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__,
-           &Cpu::sec__, &Cpu::and__, &Cpu::nop__, &Cpu::rla__, &Cpu::nop__, &Cpu::and__, &Cpu::rol_m, &Cpu::rla__, // 0x3
-    /*0x4*/&Cpu::rti__, &Cpu::eor__, &Cpu::nop__, &Cpu::sre__, &Cpu::nop__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__,
-           &Cpu::pha__, &Cpu::eor__, &Cpu::lsr_a, &Cpu::alr__, &Cpu::jmp__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__, // 0x4
-    /*0x5*/&Cpu::bvm__, &Cpu::eor__, &Cpu::nop__, &Cpu::sre__, &Cpu::nop__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__,
-           &Cpu::cli__, &Cpu::eor__, &Cpu::nop__, &Cpu::sre__, &Cpu::nop__, &Cpu::eor__, &Cpu::lsr_m, &Cpu::sre__, // 0x5
-    /*0x6*/&Cpu::rts__, &Cpu::adc__, &Cpu::nop__, &Cpu::rra__, &Cpu::nop__, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__,
-           &Cpu::pla__, &Cpu::adc__, &Cpu::ror_a, &Cpu::arr__, &Cpu::jmp_i, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__, // 0x6
-    /*0x7*/&Cpu::bvs__, &Cpu::adc__, &Cpu::nop__, &Cpu::rra__, &Cpu::nop__, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__,
-           &Cpu::sei__, &Cpu::adc__, &Cpu::nop__, &Cpu::rra__, &Cpu::nop__, &Cpu::adc__, &Cpu::ror_m, &Cpu::rra__, // 0x7
-    /*0x8*/&Cpu::nop__, &Cpu::sta__, &Cpu::nop__, &Cpu::sax__, &Cpu::sty__, &Cpu::sta__, &Cpu::stx__, &Cpu::sax__,
-           &Cpu::dey__, &Cpu::nop__, &Cpu::txa__, &Cpu::xaa__, &Cpu::sty__, &Cpu::sta__, &Cpu::stx__, &Cpu::sax__, // 0x8
-    /*0x9*/&Cpu::bcc__, &Cpu::sta__, &Cpu::nop__, &Cpu::ahc__, &Cpu::sty__, &Cpu::sta__, &Cpu::stx__, &Cpu::sax__,
-           &Cpu::tya__, &Cpu::sta__, &Cpu::txs__, &Cpu::xas__, &Cpu::shy__, &Cpu::sta__, &Cpu::shx__, &Cpu::ahc__, // 0x9
-    /*0xA*/&Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__,
-           &Cpu::tay__, &Cpu::lda__, &Cpu::tax__, &Cpu::lax__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__, // 0xA
-    /*0xB*/&Cpu::bcs__, &Cpu::lda__, &Cpu::nop__, &Cpu::lax__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__,
-           &Cpu::clv__, &Cpu::lda__, &Cpu::tsx__, &Cpu::lar__, &Cpu::ldy__, &Cpu::lda__, &Cpu::ldx__, &Cpu::lax__, // 0xB
-    /*0xC*/&Cpu::cpy__, &Cpu::cmp__, &Cpu::nop__, &Cpu::dcp__, &Cpu::cpy__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__,
-           &Cpu::iny__, &Cpu::cmp__, &Cpu::dex__, &Cpu::axs__, &Cpu::cpy__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__, // 0xC
-    /*0xD*/&Cpu::bne__, &Cpu::cmp__, &Cpu::nop__, &Cpu::dcp__, &Cpu::nop__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__,
-           &Cpu::cld__, &Cpu::cmp__, &Cpu::nop__, &Cpu::dcp__, &Cpu::nop__, &Cpu::cmp__, &Cpu::dec__, &Cpu::dcp__, // 0xD
-    /*0xE*/&Cpu::cpx__, &Cpu::sdc__, &Cpu::nop__, &Cpu::isc__, &Cpu::cpx__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__,
-           &Cpu::inx__, &Cpu::sdc__, &Cpu::nop__, &Cpu::sdc__, &Cpu::cpx__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__, // 0xE
-    /*0xF*/&Cpu::beq__, &Cpu::sdc__, &Cpu::nop__, &Cpu::isc__, &Cpu::nop__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__,
-           &Cpu::sed__, &Cpu::sdc__, &Cpu::nop__, &Cpu::isc__, &Cpu::nop__, &Cpu::sdc__, &Cpu::inc__, &Cpu::isc__, // 0xF
-    };
-
-    m_opcode = m_emu.memory().read(m_regPc.v);
-    m_regPc.v++;
+    NESCORE_PROFILE_SCOPE(m_emu.profiler(), CpuClock);
+
+    const auto startCycles = m_opcodeHistogramEnabled ? m_emu.cycles() : 0;
+
+    if(!m_decodeCache.empty())
+        (this->*fetchDecoded())();
+    else
+    {
+        m_opcode = m_emu.memory().read(m_regPc.v);
+        m_regPc.v++;
+
+        if(m_dispatch == Dispatch::Fused)
+            (this->*cpuFusedHandlers[m_opcode])();
+        else
+        {
+            (this->*cpuAddressings[m_opcode])();
+            (this->*cpuInstructions[m_opcode])();
+        }
+    }
+
+    m_instructions++;
 
-    (this->*cpuAddressings[m_opcode])();
-    (this->*cpuInstructions[m_opcode])();
+    if(m_opcodeHistogramEnabled)
+    {
+        auto &counter = m_opcodeHistogram[m_opcode];
+        counter.executions++;
+        counter.cycles += m_emu.cycles() - startCycles;
+    }
 
     //handle interrupts
     if(m_irqPin || m_nmiPin)
@@ -132,8 +256,43 @@ void Cpu::clock()
     }
 }
 
+Cpu::Handler Cpu::fetchDecoded()
+{
+    auto &memory = m_emu.memory();
+    const auto pc = m_regPc.v++;
+
+    memory.readCycle(pc);
+
+    // looked up after the bus cycle, like a normal read does
+    const auto page = memory.board()->prgReadPage(pc);
+    auto &entry = m_decodeCache[pc & (decodeCacheSize - 1)];
+    if(page && entry.page == page && entry.pc == pc)
+    {
+        m_decodeCacheStats.hits++;
+        m_opcode = entry.opcode;
+        return entry.handler;
+    }
+
+    m_decodeCacheStats.misses++;
+    m_opcode = memory.readValue(pc);
+    const auto handler = cpuFusedHandlers[m_opcode];
+
+    if(page && memory.board()->prgReadPageIsRom(pc))
+    {
+        if(entry.page && entry.pc == pc)
+            m_decodeCacheStats.invalidations++;
+        entry = { page, pc, m_opcode, handler };
+    }
+
+    return handler;
+}
+
 void Cpu::hardReset()
 {
+    // the pages of a previously loaded rom might get reused
+    if(!m_decodeCache.empty())
+        m_decodeCache.assign(decodeCacheSize, {});
+
     m_regA = 0;
     m_regX = 0;
     m_regY = 0;
@@ -1218,17 +1377,17 @@ void Cpu::xas__()
     m_emu.memory().write(m_regEa.v, m_regSp.l);
 }
 
-void Cpu::writeState(QDataStream &dataStream) const
+void Cpu::writeState(SnapshotWriter &snapshot) const
 {
-    dataStream << m_regPc.v << m_regSp.v << m_regEa.v << m_regA << m_regX << m_regY
-               << m_flagN << m_flagV << m_flagD << m_flagI << m_flagZ << m_flagC
-               << m_m << m_opcode << m_irqPin << m_nmiPin << m_suspendNmi << m_suspendIrq;
+    snapshot << m_regPc.v << m_regSp.v << m_regEa.v << m_regA << m_regX << m_regY
+             << m_flagN << m_flagV << m_flagD << m_flagI << m_flagZ << m_flagC
+             << m_m << m_opcode << m_irqPin << m_nmiPin << m_suspendNmi << m_suspendIrq;
 }
 
-void Cpu::readState(QDataStream &dataStream)
+void Cpu::readState(SnapshotReader &snapshot)
 {
-    dataStream >> m_regPc.v >> m_regSp.v >> m_regEa.v >> m_regA >> m_regX >> m_regY
-               >> m_flagN >> m_flagV >> m_flagD >> m_flagI >> m_flagZ >> m_flagC
+    snapshot >> m_regPc.v >> m_regSp.v >> m_regEa.v >> m_regA >> m_regX >> m_regY
+             >> m_flagN >> m_flagV >> m_flagD >> m_flagI >> m_flagZ >> m_flagC
             >> m_m >> m_opcode >> m_irqPin >> m_nmiPin >> m_suspendNmi >> m_suspendIrq;
 }
 
@@ -1266,3 +1425,86 @@ void Cpu::setIrqPin(bool irqPin)
 {
     m_irqPin = irqPin;
 }
+
+Cpu::Dispatch Cpu::dispatch() const
+{
+    return m_dispatch;
+}
+
+void Cpu::setDispatch(Cpu::Dispatch dispatch)
+{
+    m_dispatch = dispatch;
+}
+
+quint64 Cpu::instructions() const
+{
+    return m_instructions;
+}
+
+bool Cpu::opcodeHistogramEnabled() const
+{
+    return m_opcodeHistogramEnabled;
+}
+
+void Cpu::setOpcodeHistogramEnabled(bool opcodeHistogramEnabled)
+{
+    m_opcodeHistogramEnabled = opcodeHistogramEnabled;
+}
+
+const Cpu::OpcodeHistogram &Cpu::opcodeHistogram() const
+{
+    return m_opcodeHistogram;
+}
+
+void Cpu::resetOpcodeHistogram()
+{
+    m_opcodeHistogram = OpcodeHistogram {};
+}
+
+bool Cpu::decodeCacheEnabled() const
+{
+    return !m_decodeCache.empty();
+}
+
+void Cpu::setDecodeCacheEnabled(bool decodeCacheEnabled)
+{
+    if(decodeCacheEnabled == this->decodeCacheEnabled())
+        return;
+
+    if(decodeCacheEnabled)
+        m_decodeCache.assign(decodeCacheSize, {});
+    else
+        std::vector<DecodedOpcode>().swap(m_decodeCache);
+}
+
+const Cpu::DecodeCacheStats &Cpu::decodeCacheStats() const
+{
+    return m_decodeCacheStats;
+}
+
+void Cpu::resetDecodeCacheStats()
+{
+    m_decodeCacheStats = DecodeCacheStats {};
+}
+
+Cpu::Statistics Cpu::statistics() const
+{
+    return Statistics { m_instructions, m_opcodeHistogram, m_decodeCacheStats };
+}
+
+void Cpu::setStatistics(const Statistics &statistics)
+{
+    m_instructions = statistics.instructions;
+    m_opcodeHistogram = statistics.opcodeHistogram;
+    m_decodeCacheStats = statistics.decodeCacheStats;
+}
+
+const char *Cpu::instructionName(quint8 opcode)
+{
+    return instructionNames[opcode];
+}
+
+const char *Cpu::addressingName(quint8 opcode)
+{
+    return addressingNames[opcode];
+}
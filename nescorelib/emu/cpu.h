@@ -5,9 +5,15 @@
 // Qt includes
 #include <QtGlobal>
 
+// system includes
+#include <array>
+#include <utility>
+#include <vector>
+
 // forward declarations
 class NesEmulator;
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 
 class NESCORELIB_EXPORT Cpu
 {
@@ -21,6 +27,27 @@ class NESCORELIB_EXPORT Cpu
     };
 
 public:
+    enum class Dispatch { Table, Fused };
+
+    struct OpcodeCounter {
+        quint64 executions {};
+        quint64 cycles {}; // from the opcode fetch to the end of the instruction, dma stalls included
+    };
+    using OpcodeHistogram = std::array<OpcodeCounter, 256>;
+
+    struct DecodeCacheStats {
+        quint64 hits {};
+        quint64 misses {};
+        quint64 invalidations {}; // entries found with another bank mapped at their pc
+    };
+
+    // What the cpu counted so far, not part of the state
+    struct Statistics {
+        quint64 instructions {};
+        OpcodeHistogram opcodeHistogram {};
+        DecodeCacheStats decodeCacheStats {};
+    };
+
     explicit Cpu(NesEmulator &emu);
 
     quint8 getRegisterP() const;
@@ -38,8 +65,8 @@ public:
     quint8 _pull();
     quint8 pull();
 
-    void writeState(QDataStream &dataStream) const;
-    void readState(QDataStream &dataStream);
+    void writeState(SnapshotWriter &snapshot) const;
+    void readState(SnapshotReader &snapshot);
 
     bool suspendNmi() const;
     bool suspendIrq() const;
@@ -51,7 +78,56 @@ public:
     bool irqPin() const;
     void setIrqPin(bool irqPin);
 
+    Dispatch dispatch() const;
+    void setDispatch(Dispatch dispatch);
+
+    quint64 instructions() const;
+
+    // Counts executions and cycles of every opcode, off by default
+    bool opcodeHistogramEnabled() const;
+    void setOpcodeHistogramEnabled(bool opcodeHistogramEnabled);
+    const OpcodeHistogram &opcodeHistogram() const;
+    void resetOpcodeHistogram();
+
+    // Keeps the opcodes fetched from prg rom with their fused handler, keyed by pc and the
+    // rom page mapped there, so a bank switch invalidates them. Code in ram never gets
+    // cached. The opcode fetch stays a full bus cycle. Dispatches fused while enabled.
+    bool decodeCacheEnabled() const;
+    void setDecodeCacheEnabled(bool decodeCacheEnabled);
+    const DecodeCacheStats &decodeCacheStats() const;
+    void resetDecodeCacheStats();
+
+    Statistics statistics() const;
+    void setStatistics(const Statistics &statistics);
+
+    // Names of the handlers an opcode dispatches to, e.g. "lda" and "absX_r"
+    static const char *instructionName(quint8 opcode);
+    static const char *addressingName(quint8 opcode);
+
 private:
+    using Handler = void (Cpu::*)();
+
+    struct DecodedOpcode {
+        const quint8 *page; // rom page mapped at pc when it was decoded
+        quint16 pc;
+        quint8 opcode;
+        Handler handler;
+    };
+
+    static constexpr std::size_t decodeCacheSize = 0x2000;
+
+    Handler fetchDecoded();
+
+    template<quint8 opcode>
+    void fused();
+
+    template<std::size_t ...opcodes>
+    static constexpr std::array<void (Cpu::*)(), 256> makeFusedHandlers(std::index_sequence<opcodes...>);
+
+    static const std::array<void (Cpu::*)(), 256> cpuAddressings;
+    static const std::array<void (Cpu::*)(), 256> cpuInstructions;
+    static const std::array<void (Cpu::*)(), 256> cpuFusedHandlers;
+
     // addressing modes
     void imp____();     void zpgX_r_();    void abs_rw_();
     void indX_r_();     void zpgX_w_();    void absX_r_();
@@ -111,4 +187,13 @@ private:
     bool m_nmiPin {};
     bool m_suspendNmi {};
     bool m_suspendIrq {};
+
+    Dispatch m_dispatch;
+    quint64 m_instructions {}; // executed instructions since construction
+
+    bool m_opcodeHistogramEnabled {};
+    OpcodeHistogram m_opcodeHistogram {};
+
+    std::vector<DecodedOpcode> m_decodeCache; // empty while disabled
+    DecodeCacheStats m_decodeCacheStats {};
 };
@@ -1,10 +1,8 @@
 #include "dma.h"
 
-// Qt includes
-#include <QDataStream>
-
 // local includes
 #include "nesemulator.h"
+#include "snapshot.h"
 
 Dma::Dma(NesEmulator &emu) :
     m_emu(emu)
@@ -87,6 +85,8 @@ void Dma::assertOamDma()
 
 void Dma::clock()
 {
+    NESCORE_PROFILE_SCOPE(m_emu.profiler(), DmaClock);
+
     if(m_oamFinishCounter > 0)
         m_oamFinishCounter--;
 
@@ -181,16 +181,16 @@ void Dma::clock()
     }
 }
 
-void Dma::writeState(QDataStream &dataStream) const
+void Dma::writeState(SnapshotWriter &snapshot) const
 {
-    dataStream << m_dmcDmaWaitCycles << m_oamDmaWaitCycles << m_isOamDma << m_dmcOn << m_oamOn << m_dmcOccurring
-               << m_oamOccurring << m_oamFinishCounter << m_oamAddress << m_oamCycle << m_latch;
+    snapshot << m_dmcDmaWaitCycles << m_oamDmaWaitCycles << m_isOamDma << m_dmcOn << m_oamOn << m_dmcOccurring
+             << m_oamOccurring << m_oamFinishCounter << m_oamAddress << m_oamCycle << m_latch;
 }
 
-void Dma::readState(QDataStream &dataStream)
+void Dma::readState(SnapshotReader &snapshot)
 {
-    dataStream >> m_dmcDmaWaitCycles >> m_oamDmaWaitCycles >> m_isOamDma >> m_dmcOn >> m_oamOn >> m_dmcOccurring
-               >> m_oamOccurring >> m_oamFinishCounter >> m_oamAddress >> m_oamCycle >> m_latch;
+    snapshot >> m_dmcDmaWaitCycles >> m_oamDmaWaitCycles >> m_isOamDma >> m_dmcOn >> m_oamOn >> m_dmcOccurring
+             >> m_oamOccurring >> m_oamFinishCounter >> m_oamAddress >> m_oamCycle >> m_latch;
 }
 
 void Dma::setOamAddress(quint16 oamAddress)
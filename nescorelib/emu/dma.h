@@ -7,7 +7,8 @@
 
 // forward declarations
 class NesEmulator;
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 
 class NESCORELIB_EXPORT Dma
 {
@@ -22,8 +23,8 @@ public:
 
     void clock();
 
-    void writeState(QDataStream &dataStream) const;
-    void readState(QDataStream &dataStream);
+    void writeState(SnapshotWriter &snapshot) const;
+    void readState(SnapshotReader &snapshot);
 
     void setOamAddress(quint16 oamAddress);
 
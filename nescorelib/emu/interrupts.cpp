@@ -1,10 +1,8 @@
 #include "interrupts.h"
 
-// Qt includes
-#include <QDataStream>
-
 // local includes
 #include "nesemulator.h"
+#include "snapshot.h"
 
 Interrupts::Interrupts(NesEmulator &emu) :
     m_emu(emu)
@@ -28,14 +26,14 @@ void Interrupts::pollStatus()
     m_vector = m_emu.cpu().nmiPin() ? 0xFFFA : 0xFFFE;
 }
 
-void Interrupts::writeState(QDataStream &dataStream) const
+void Interrupts::writeState(SnapshotWriter &snapshot) const
 {
-    dataStream << m_flags << m_ppuNmiCurrent << m_ppuNmiOld << m_vector;
+    snapshot << m_flags << m_ppuNmiCurrent << m_ppuNmiOld << m_vector;
 }
 
-void Interrupts::readState(QDataStream &dataStream)
+void Interrupts::readState(SnapshotReader &snapshot)
 {
-    dataStream >> m_flags >> m_ppuNmiCurrent >> m_ppuNmiOld >> m_vector;
+    snapshot >> m_flags >> m_ppuNmiCurrent >> m_ppuNmiOld >> m_vector;
 }
 
 qint32 Interrupts::flags() const
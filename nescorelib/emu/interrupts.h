@@ -7,7 +7,8 @@
 
 // forward declarations
 class NesEmulator;
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 
 class NESCORELIB_EXPORT Interrupts
 {
@@ -16,8 +17,8 @@ public:
 
     void pollStatus();
 
-    void writeState(QDataStream &dataStream) const;
-    void readState(QDataStream &dataStream);
+    void writeState(SnapshotWriter &snapshot) const;
+    void readState(SnapshotReader &snapshot);
 
     enum IrqFlag {
         IRQ_APU = 1,
@@ -1,11 +1,5 @@
 #include "memory.h"
 
-// Qt includes
-#include <QDataStream>
-
-// dbcorelib includes
-#include "utils/datastreamutils.h"
-
 // local includes
 #include "nesemulator.h"
 #include "rom.h"
@@ -14,6 +8,7 @@
 #include "mappers/mapper002.h"
 #include "mappers/mapper003.h"
 #include "mappers/mapper004.h"
+#include "snapshot.h"
 
 Memory::Memory(NesEmulator &emu) :
     m_emu(emu)
@@ -38,6 +33,19 @@ void Memory::initialize(const Rom &rom)
 {
     m_board = getBoard(rom);
     m_board->mapper();
+
+    updateBoardHooks();
+}
+
+void Memory::updateBoardHooks()
+{
+    if(!m_board)
+        return;
+
+    m_boardHooks = m_boardHookMaskEnabled ? m_board->hooks() : Board::HookAll;
+
+    if(!m_board->enableExternalSound())
+        m_boardHooks &= ~Board::HookExternalSound;
 }
 
 void Memory::hardReset()
@@ -82,10 +90,23 @@ void Memory::writeWRam(const quint16 address, const quint8 value)
 }
 
 quint8 Memory::_read(quint16 address)
+{
+    readCycle(address);
+    return readValue(address);
+}
+
+void Memory::readCycle(quint16 address)
 {
     m_busRw = true;
     m_busAddress = address;
     m_emu.emuClockComponents();
+}
+
+quint8 Memory::readValue(quint16 address)
+{
+    // plain prg rom and ram reads skip the board handlers
+    if(const auto page = m_board->prgReadPage(address))
+        return page[address & 0xFFF];
 
     const auto roundAddress = [](quint16 address) { return (address & 0xF000) >> 12; };
     switch(roundAddress(address))
@@ -95,6 +116,7 @@ quint8 Memory::_read(quint16 address)
         return readWRam(address);
     case roundAddress(0x2000):
     case roundAddress(0x3000):
+        m_emu.ppuCatchUp();
         return m_emu.ppu().ioRead(address);
     case roundAddress(0x4000):
         return m_emu.apu().ioRead(address);
@@ -139,6 +161,7 @@ void Memory::write(quint16 address, quint8 value)
         break;
     case roundAddress(0x2000):
     case roundAddress(0x3000):
+        m_emu.ppuCatchUp();
         m_emu.ppu().ioWrite(address, value);
         break;
     case roundAddress(0x4000):
@@ -173,6 +196,8 @@ quint8 Memory::readEx(const quint16 address)
 
 void Memory::writeEx(const quint16 address, const quint8 value)
 {
+    // the board might switch banks the ppu reads from
+    m_emu.ppuCatchUp();
     m_board->writeEx(address, value);
 }
 
@@ -183,6 +208,7 @@ quint8 Memory::readSrm(const quint16 address)
 
 void Memory::writeSrm(const quint16 address, const quint8 value)
 {
+    m_emu.ppuCatchUp();
     m_board->writeSrm(address, value);
 }
 
@@ -193,19 +219,20 @@ quint8 Memory::readPrg(const quint16 address)
 
 void Memory::writePrg(const quint16 address, const quint8 value)
 {
+    m_emu.ppuCatchUp();
     m_board->writePrg(address, value);
 }
 
-void Memory::readState(QDataStream &dataStream)
+void Memory::readState(SnapshotReader &snapshot)
 {
-    dataStream >> m_wram >> m_busRw >> m_busAddress;
-    m_board->readState(dataStream);
+    snapshot >> m_wram >> m_busRw >> m_busAddress;
+    m_board->readState(snapshot);
 }
 
-void Memory::writeState(QDataStream &dataStream) const
+void Memory::writeState(SnapshotWriter &snapshot) const
 {
-    dataStream << m_wram << m_busRw << m_busAddress;
-    m_board->writeState(dataStream);
+    snapshot << m_wram << m_busRw << m_busAddress;
+    m_board->writeState(snapshot);
 }
 
 Board *Memory::board()
@@ -218,6 +245,17 @@ const Board *Memory::board() const
     return m_board.get();
 }
 
+bool Memory::boardHookMaskEnabled() const
+{
+    return m_boardHookMaskEnabled;
+}
+
+void Memory::setBoardHookMaskEnabled(bool boardHookMaskEnabled)
+{
+    m_boardHookMaskEnabled = boardHookMaskEnabled;
+    updateBoardHooks();
+}
+
 bool Memory::busRw() const
 {
     return m_busRw;
@@ -12,7 +12,8 @@
 #include "boards/board.h"
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 class NesEmulator;
 class Board;
 struct Rom;
@@ -27,6 +28,8 @@ public:
     void initialize(const Rom &rom);
     void hardReset();
 
+    void updateBoardHooks();
+
     void loadSram();
     void reloadGameGenieCodes();
 
@@ -36,6 +39,12 @@ public:
 
     quint8 _read(quint16 address);
     quint8 read(quint16 address);
+
+    // The two halves of a read: the bus cycle, which clocks all the other components, and
+    // the value lookup after it
+    void readCycle(quint16 address);
+    quint8 readValue(quint16 address);
+
     void write(quint16 address, quint8 value);
 
     quint8 readEx(const quint16 address);
@@ -45,12 +54,17 @@ public:
     quint8 readPrg(const quint16 address);
     void writePrg(const quint16 address, const quint8 value);
 
-    void readState(QDataStream &dataStream);
-    void writeState(QDataStream &dataStream) const;
+    void readState(SnapshotReader &snapshot);
+    void writeState(SnapshotWriter &snapshot) const;
 
     Board *board();
     const Board *board() const;
 
+    // Skip the board clock callbacks the board does not implement, on by default
+    bool boardHookMaskEnabled() const;
+    void setBoardHookMaskEnabled(bool boardHookMaskEnabled);
+    bool boardHooked(Board::Hook hook) const { return m_boardHooks & hook; }
+
     bool busRw() const;
     quint16 busAddress() const;
 
@@ -63,6 +77,9 @@ private:
     std::array<quint8, 0x0800> m_wram {};
     std::unique_ptr<Board> m_board {};
 
+    bool m_boardHookMaskEnabled { true };
+    quint32 m_boardHooks {};
+
     bool m_busRw {};
     quint16 m_busAddress {};
 };
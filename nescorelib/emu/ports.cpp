@@ -1,7 +1,7 @@
 #include "ports.h"
 
-// Qt includes
-#include <QDataStream>
+// local includes
+#include "snapshot.h"
 
 Ports::Ports(NesEmulator &emu) :
     m_emu(emu)
@@ -17,19 +17,33 @@ void Ports::update()
 
 void Ports::updatePorts()
 {
-    const auto getData = [this](int index){ return m_inputs[index] ? m_inputs[index]->getData() : 0; };
-    m_port0 = getData(2) << 8 | getData(0) | 0x01010000;
-    m_port1 = getData(3) << 8 | getData(1) | 0x02020000;
+    m_port0 = inputData(2) << 8 | inputData(0) | 0x01010000;
+    m_port1 = inputData(3) << 8 | inputData(1) | 0x02020000;
 }
 
-void Ports::portWriteState(QDataStream &dataStream) const
+InputProvider *Ports::input(int index) const
 {
-    dataStream << m_port0 << m_port1;
+    return m_inputs[index].get();
 }
 
-void Ports::portReadState(QDataStream &dataStream)
+void Ports::setInput(int index, std::unique_ptr<InputProvider> &&input)
 {
-    dataStream >> m_port0 >> m_port1;
+    m_inputs[index] = std::move(input);
+}
+
+quint8 Ports::inputData(int index) const
+{
+    return m_inputs[index] ? m_inputs[index]->getData() : 0;
+}
+
+void Ports::portWriteState(SnapshotWriter &snapshot) const
+{
+    snapshot << m_port0 << m_port1;
+}
+
+void Ports::portReadState(SnapshotReader &snapshot)
+{
+    snapshot >> m_port0 >> m_port1;
 }
 
 quint32 Ports::port0() const
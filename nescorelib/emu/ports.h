@@ -6,6 +6,7 @@
 #include <QtGlobal>
 
 // system includes
+#include <array>
 #include <memory>
 
 // local includes
@@ -13,18 +14,26 @@
 
 // forward declarations
 class NesEmulator;
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 
 class NESCORELIB_EXPORT Ports
 {
 public:
     explicit Ports(NesEmulator &emu);
 
+    // Polls all input providers, the frontend calls this once before every frame
     void update();
     void updatePorts();
 
-    void portWriteState(QDataStream &dataStream) const;
-    void portReadState(QDataStream &dataStream);
+    InputProvider *input(int index) const;
+    void setInput(int index, std::unique_ptr<InputProvider> &&input);
+
+    // What the input provider of controller index (0 - 3) reports, 0 without one
+    quint8 inputData(int index) const;
+
+    void portWriteState(SnapshotWriter &snapshot) const;
+    void portReadState(SnapshotReader &snapshot);
 
     quint32 port0() const;
     void setPort0(quint32 port0);
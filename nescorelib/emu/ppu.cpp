@@ -1,17 +1,29 @@
 #include "ppu.h"
 
-// Qt includes
-#include <QDataStream>
-
-// dbcorelib includes
-#include "utils/datastreamutils.h"
-
 // local includes
 #include "nesemulator.h"
 #include "emusettings.h"
+#include "ppukernels.h"
+#include "snapshot.h"
+
+namespace {
+constexpr std::array<void (Ppu::*)(), 8> ppuBkgFetches {
+    &Ppu::bkgFetch0, &Ppu::bkgFetch1, &Ppu::bkgFetch2, &Ppu::bkgFetch3,
+    &Ppu::bkgFetch4, &Ppu::bkgFetch5, &Ppu::bkgFetch6, &Ppu::bkgFetch7
+};
+
+constexpr std::array<void (Ppu::*)(), 8> ppuSprFetches {
+    &Ppu::bkgFetch0, &Ppu::bkgFetch1, &Ppu::bkgFetch2, &Ppu::bkgFetch3,
+    &Ppu::sprFetch0, &Ppu::sprFetch1, &Ppu::sprFetch2, &Ppu::sprFetch3
+};
+
+constexpr std::array<void (Ppu::*)(), 9> ppuOamPhases {
+    &Ppu::oamPhase0, &Ppu::oamPhase1, &Ppu::oamPhase2, &Ppu::oamPhase3, &Ppu::oamPhase4,
+    &Ppu::oamPhase5, &Ppu::oamPhase6, &Ppu::oamPhase7, &Ppu::oamPhase8
+};
+}
 
 Ppu::Ppu(NesEmulator &emu) :
-    QObject(&emu),
     m_emu(emu)
 {
 }
@@ -90,7 +102,11 @@ void Ppu::clock()
         &Ppu::onRegister2004, &Ppu::onRegister2005, &Ppu::onRegister2006, &Ppu::onRegister2007
     };
 
-    m_emu.memory().board()->onPpuClock();
+    if(m_emu.memory().boardHooked(Board::HookPpuClock))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuClock);
+        m_emu.memory().board()->onPpuClock();
+    }
 
     // Clock a scanline
     const auto callback = ppuVClocks[m_ppuClockV];
@@ -99,14 +115,21 @@ void Ppu::clock()
     // Advance
     if(m_ppuClockH == 340)
     {
-        m_emu.memory().board()->onPpuScanlineTick();
+        if(m_ppuClockV < SCREEN_HEIGHT)
+            m_dotScanlines++;
+
+        if(m_emu.memory().boardHooked(Board::HookPpuScanlineTick))
+        {
+            NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuScanlineTick);
+            m_emu.memory().board()->onPpuScanlineTick();
+        }
 
         // Advance scanline ...
         if(m_ppuClockV == EmuSettings::ppuClockVBlankEnd)
         {
             m_ppuClockV = 0;
 
-            Q_EMIT frameFinished(m_ppuScreenPixels);
+            m_emu.frameFinished();
         }
         else
             m_ppuClockV++;
@@ -132,20 +155,7 @@ void Ppu::clock()
 
 void Ppu::scanlineRender()
 {
-    static constexpr std::array<void (Ppu::*)(), 8> ppuBkgFetches {
-        &Ppu::bkgFetch0, &Ppu::bkgFetch1, &Ppu::bkgFetch2, &Ppu::bkgFetch3,
-        &Ppu::bkgFetch4, &Ppu::bkgFetch5, &Ppu::bkgFetch6, &Ppu::bkgFetch7
-    };
-
-    static constexpr std::array<void (Ppu::*)(), 8> ppuSprFetches {
-        &Ppu::bkgFetch0, &Ppu::bkgFetch1, &Ppu::bkgFetch2, &Ppu::bkgFetch3,
-        &Ppu::sprFetch0, &Ppu::sprFetch1, &Ppu::sprFetch2, &Ppu::sprFetch3
-    };
-
-    static constexpr std::array<void (Ppu::*)(), 9> ppuOamPhases {
-        &Ppu::oamPhase0, &Ppu::oamPhase1, &Ppu::oamPhase2, &Ppu::oamPhase3, &Ppu::oamPhase4,
-        &Ppu::oamPhase5, &Ppu::oamPhase6, &Ppu::oamPhase7, &Ppu::oamPhase8
-    };
+    NESCORE_PROFILE_SCOPE(m_emu.profiler(), PpuScanlineRender);
 
     // 0 - 239 scanlines and pre-render scanline 261
     if(m_ppuClockH > 0)
@@ -234,6 +244,111 @@ void Ppu::scanlineRender()
     }// else is the idle clock
 }
 
+bool Ppu::scanlineFastPossible() const
+{
+    // Only whole visible lines with rendering enabled, the register state has to stay
+    // the same for the whole line.
+    return m_fastScanlinesEnabled && m_ppuClockH == 0 && m_ppuClockV < SCREEN_HEIGHT &&
+           isRenderingOn() && !m_ppuRegAccessHappened;
+}
+
+void Ppu::scanlineRenderFast()
+{
+    NESCORE_PROFILE_SCOPE(m_emu.profiler(), PpuScanlineRenderFast);
+
+    // Renders a complete visible scanline (H clocks 0 - 340) with the same results as 341
+    // calls to clock(). The board must not care about ppu clocks or the ppu address bus,
+    // which is the case when it allows catching up the ppu.
+    Board &board = *m_emu.memory().board();
+
+    // H clocks 1 - 64, clear the secondary oam
+    m_ppuOamBankSecondary.fill(0xFF);
+
+    // H clocks 65 - 256, sprite evaluation
+    oamReset();
+    for(auto h = 65; h <= SCREEN_WIDTH; h += 2)
+    {
+        oamEvFetch();
+        (this->*ppuOamPhases[m_ppuPhaseIndex])();
+    }
+
+    // H clocks 1 - 256, bkg fetches. A tile is always fetched at least 2 clocks before its
+    // pixels get rendered, so the whole line can be fetched and decoded first.
+    constexpr auto tiles = SCREEN_WIDTH / 8;
+    std::array<quint8, tiles> lowBits;
+    std::array<quint8, tiles> highBits;
+    std::array<quint8, tiles> attributes;
+
+    for(std::size_t tile = 0; tile < tiles; tile++)
+    {
+        m_ppuBkgfetchNtAddr = 0x2000 | (m_ppuVramAddr & 0x0FFF);
+        m_ppuBkgfetchNtData = fetchNmt(m_ppuBkgfetchNtAddr);
+        m_ppuBkgfetchAtAddr = 0x23C0 | (m_ppuVramAddr & 0xC00) | ((m_ppuVramAddr >> 4) & 0x38) | ((m_ppuVramAddr >> 2) & 0x7);
+        m_ppuBkgfetchAtData = fetchNmt(m_ppuBkgfetchAtAddr);
+        m_ppuBkgfetchAtData = m_ppuBkgfetchAtData >> ((m_ppuVramAddr >> 4 & 0x04) | (m_ppuVramAddr & 0x02));
+        m_ppuBkgfetchLbAddr = m_ppuReg2000BackgroundPatternTableAddress | (m_ppuBkgfetchNtData << 4) | (m_ppuVramAddr >> 12 & 7);
+        m_ppuBkgfetchHbAddr = m_ppuReg2000BackgroundPatternTableAddress | (m_ppuBkgfetchNtData << 4) | 8 | (m_ppuVramAddr >> 12 & 7);
+
+        lowBits[tile] = fetchChr(m_ppuBkgfetchLbAddr);
+        highBits[tile] = fetchChr(m_ppuBkgfetchHbAddr);
+        attributes[tile] = (m_ppuBkgfetchAtData << 2) & 0xC;
+
+        if(tile == tiles - 1)
+            bkgIncrementY();
+        else
+            bkgIncrementX();
+    }
+
+    // the tile fetched at H clock 8 lands at position 17
+    PpuKernels::decodeTileRows(lowBits.data(), highBits.data(), attributes.data(), tiles, &m_ppuBkgPixels[17]);
+    m_ppuBkgfetchLbData = 0;
+    m_ppuBkgfetchHbData = 0;
+
+    // H clocks 1 - 256, pixels. The sprite pixels get cleared before the last one.
+    std::array<quint8, SCREEN_WIDTH> addresses;
+    for(auto x = 0; x < int(SCREEN_WIDTH) - 1; x++)
+        addresses[x] = mixPixel(x) & 0x1F;
+    oamClear();
+    addresses[SCREEN_WIDTH - 1] = mixPixel(SCREEN_WIDTH - 1) & 0x1F;
+
+    std::array<qint32, 32> lut;
+    PpuKernels::buildPaletteLut(m_ppuPaletteBank, m_ppuColorAnd, lut);
+    PpuKernels::lookupPalette(addresses.data(), SCREEN_WIDTH, lut, &m_ppuScreenPixels[m_ppuClockV * SCREEN_WIDTH]);
+
+    // H clocks 257 - 320, bkg garbage fetches and sprite fetches
+    for(m_ppuClockH = SCREEN_WIDTH + 1; m_ppuClockH < 321; m_ppuClockH += 8)
+    {
+        bkgFetch0();
+        if(m_ppuClockH == SCREEN_WIDTH + 1)
+            m_ppuVramAddr = (m_ppuVramAddr & 0x7BE0) | (m_ppuVramAddrTemp & 0x041F);
+        bkgFetch1();
+        bkgFetch2();
+        bkgFetch3();
+
+        m_ppuClockH += 4;
+        sprFetch0();
+        sprFetch1();
+        sprFetch2();
+        sprFetch3();
+        m_ppuClockH -= 4;
+    }
+
+    // H clocks 321 - 340, bkg dummy fetches
+    for(m_ppuClockH = 321; m_ppuClockH <= 340; m_ppuClockH++)
+        (this->*ppuBkgFetches[(m_ppuClockH - 1) & 7])();
+
+    m_fastScanlines++;
+
+    if(m_emu.memory().boardHooked(Board::HookPpuScanlineTick))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuScanlineTick);
+        board.onPpuScanlineTick();
+    }
+
+    m_ppuClockV++;
+    m_ppuClockH = 0;
+}
+
 void Ppu::scanlineVBlankStart()
 {
     // This is scanline 241
@@ -287,26 +402,34 @@ void Ppu::bkgFetch0()
 {
     // Calculate NT address
     m_ppuBkgfetchNtAddr = 0x2000 | (m_ppuVramAddr & 0x0FFF);
-    m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchNtAddr);
+    if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+        m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchNtAddr);
+    }
 }
 
 void Ppu::bkgFetch1()
 {
     // Fetch NT data
-    m_ppuBkgfetchNtData = m_emu.memory().board()->readNmt(m_ppuBkgfetchNtAddr);
+    m_ppuBkgfetchNtData = fetchNmt(m_ppuBkgfetchNtAddr);
 }
 
 void Ppu::bkgFetch2()
 {
     // Calculate AT address
     m_ppuBkgfetchAtAddr = 0x23C0 | (m_ppuVramAddr & 0xC00) | ((m_ppuVramAddr >> 4) & 0x38) | ((m_ppuVramAddr >> 2) & 0x7);
-    m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchAtAddr);
+    if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+        m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchAtAddr);
+    }
 }
 
 void Ppu::bkgFetch3()
 {
     // Fetch AT data
-    m_ppuBkgfetchAtData = m_emu.memory().board()->readNmt(m_ppuBkgfetchAtAddr);
+    m_ppuBkgfetchAtData = fetchNmt(m_ppuBkgfetchAtAddr);
     m_ppuBkgfetchAtData = m_ppuBkgfetchAtData >> ((m_ppuVramAddr >> 4 & 0x04) | (m_ppuVramAddr & 0x02));
 }
 
@@ -314,66 +437,94 @@ void Ppu::bkgFetch4()
 {
     // Calculate tile low-bit address
     m_ppuBkgfetchLbAddr = m_ppuReg2000BackgroundPatternTableAddress | (m_ppuBkgfetchNtData << 4) | (m_ppuVramAddr >> 12 & 7);
-    m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchLbAddr);
+    if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+        m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchLbAddr);
+    }
 }
 
 void Ppu::bkgFetch5()
 {
     // Fetch tile low-bit data
-    m_ppuBkgfetchLbData = m_emu.memory().board()->readChr(m_ppuBkgfetchLbAddr);
+    m_ppuBkgfetchLbData = fetchChr(m_ppuBkgfetchLbAddr);
 }
 
 void Ppu::bkgFetch6()
 {
     // Calculate tile high-bit address
     m_ppuBkgfetchHbAddr = m_ppuReg2000BackgroundPatternTableAddress | (m_ppuBkgfetchNtData << 4) | 8 | (m_ppuVramAddr >> 12 & 7);
-    m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchHbAddr);
+    if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+        m_emu.memory().board()->onPpuAddressUpdate(m_ppuBkgfetchHbAddr);
+    }
 }
 
 void Ppu::bkgFetch7()
 {
     // Fetch tile high-bit data
-    m_ppuBkgfetchHbData = m_emu.memory().board()->readChr(m_ppuBkgfetchHbAddr);
+    m_ppuBkgfetchHbData = fetchChr(m_ppuBkgfetchHbAddr);
 
     const auto ppuBkgRenderPos = m_ppuClockH > 320 ? m_ppuClockH - 327 : m_ppuClockH + 9;
 
-    // Rendering background pixel
-    for(auto i = 0; i < 8; i++)
-    {
-        const auto temp = ((m_ppuBkgfetchAtData << 2) & 0xC) | (m_ppuBkgfetchLbData >> 7 & 1) | (m_ppuBkgfetchHbData >> 6 & 2);
-        if((temp & 3) != 0)
-            m_ppuBkgPixels[i + ppuBkgRenderPos] = temp;
-        else
-            m_ppuBkgPixels[i + ppuBkgRenderPos] = 0;
-        m_ppuBkgfetchLbData <<= 1;
-        m_ppuBkgfetchHbData <<= 1;
-    }
+    bkgRenderTile(ppuBkgRenderPos);
 
     // Increments
     if(m_ppuClockH == SCREEN_WIDTH)
-    {
-        // Increment Y
-        if((m_ppuVramAddr & 0x7000) != 0x7000)
-            m_ppuVramAddr += 0x1000;
-        else
-        {
-            m_ppuVramAddr ^= 0x7000;
+        bkgIncrementY();
+    else
+        bkgIncrementX();
+}
 
-            switch (m_ppuVramAddr & 0x3E0)
-            {
-                case 0x3A0: m_ppuVramAddr ^= 0xBA0; break;
-                case 0x3E0: m_ppuVramAddr ^= 0x3E0; break;
-                default: m_ppuVramAddr += 0x20; break;
-            }
-        }
-    }
+void Ppu::bkgRenderTile(int ppuBkgRenderPos)
+{
+    // Rendering background pixel
+    PpuKernels::decodeTileRow(m_ppuBkgfetchLbData, m_ppuBkgfetchHbData, (m_ppuBkgfetchAtData << 2) & 0xC, false, &m_ppuBkgPixels[ppuBkgRenderPos]);
+
+    // all bits got shifted out
+    m_ppuBkgfetchLbData = 0;
+    m_ppuBkgfetchHbData = 0;
+}
+
+quint8 Ppu::fetchChr(quint16 address)
+{
+    const auto board = m_emu.memory().board();
+    if(const auto page = board->chrReadPage(address))
+        return page[address & 0x3FF];
+    return board->readChr(address);
+}
+
+quint8 Ppu::fetchNmt(quint16 address)
+{
+    const auto board = m_emu.memory().board();
+    if(const auto page = board->nmtReadPage(address))
+        return page[address & 0x3FF];
+    return board->readNmt(address);
+}
+
+void Ppu::bkgIncrementX()
+{
+    if((m_ppuVramAddr & 0x001F) == 0x001F)
+        m_ppuVramAddr ^= 0x041F;
+    else
+        m_ppuVramAddr++;
+}
+
+void Ppu::bkgIncrementY()
+{
+    if((m_ppuVramAddr & 0x7000) != 0x7000)
+        m_ppuVramAddr += 0x1000;
     else
     {
-        // Increment X
-        if((m_ppuVramAddr & 0x001F) == 0x001F)
-            m_ppuVramAddr ^= 0x041F;
-        else
-            m_ppuVramAddr++;
+        m_ppuVramAddr ^= 0x7000;
+
+        switch (m_ppuVramAddr & 0x3E0)
+        {
+            case 0x3A0: m_ppuVramAddr ^= 0xBA0; break;
+            case 0x3E0: m_ppuVramAddr ^= 0x3E0; break;
+            default: m_ppuVramAddr += 0x20; break;
+        }
     }
 }
 
@@ -392,21 +543,29 @@ void Ppu::sprFetch0()
     else
         m_ppuSprfetchLbAddr = m_ppuReg2000SpritePatternTableAddressFor8x8Sprites | (m_ppuSprfetchTData << 0x04) | (pputempcomparator & 0x0007);
 
-    m_emu.memory().board()->onPpuAddressUpdate(m_ppuSprfetchLbAddr);
+    if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+        m_emu.memory().board()->onPpuAddressUpdate(m_ppuSprfetchLbAddr);
+    }
 }
 
 void Ppu::sprFetch1()
 {
     // Fetch tile low-bit data
     m_ppuIsSprfetch = true;
-    m_ppuSprfetchLbData = m_emu.memory().board()->readChr(m_ppuSprfetchLbAddr);
+    m_ppuSprfetchLbData = fetchChr(m_ppuSprfetchLbAddr);
     m_ppuIsSprfetch = false;
 }
 
 void Ppu::sprFetch2()
 {
     m_ppuSprfetchHbAddr = m_ppuSprfetchLbAddr | 0x08;
-    m_emu.memory().board()->onPpuAddressUpdate(m_ppuSprfetchHbAddr);
+    if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+        m_emu.memory().board()->onPpuAddressUpdate(m_ppuSprfetchHbAddr);
+    }
 }
 
 void Ppu::sprFetch3()
@@ -416,65 +575,41 @@ void Ppu::sprFetch3()
 
     // Fetch tile high-bit data
     m_ppuIsSprfetch = true;
-    m_ppuSprfetchHbData = m_emu.memory().board()->readChr(m_ppuSprfetchHbAddr);
+    m_ppuSprfetchHbData = fetchChr(m_ppuSprfetchHbAddr);
     m_ppuIsSprfetch = false;
 
     // Render the sprite
-    int ppuBkgRenderPos = m_ppuSprfetchXData;
+    const bool flip = m_ppuSprfetchAtData & 0x40;
+
+    std::array<quint8, 8> pixels;
+    PpuKernels::decodeTileRow(m_ppuSprfetchLbData, m_ppuSprfetchHbData, (m_ppuSprfetchAtData << 2) & 0xC, flip, pixels.data());
 
-    if((m_ppuSprfetchAtData & 0x40) == 0)
+    // Rendering sprite pixel, the last column is never drawn
+    const auto count = std::min(8, 255 - m_ppuSprfetchXData);
+    for(auto i = 0; i < count; i++)
     {
-        // Rendering sprite pixel
-        for(auto i = 0; i < 8; i++)
-        {
-            if(ppuBkgRenderPos < 255)
-            {
-                const auto temp = ((m_ppuSprfetchAtData << 2) & 0xC) | (m_ppuSprfetchLbData >> 7 & 1) | (m_ppuSprfetchHbData >> 6 & 2);
-                if((temp & 3) != 0 && (m_ppuSprPixels[ppuBkgRenderPos] & 3) == 0)
-                    m_ppuSprPixels[ppuBkgRenderPos] = temp;
+        auto &pixel = m_ppuSprPixels[m_ppuSprfetchXData + i];
 
-                if(m_ppuSprfetchSlot == 0 && m_ppuSprite0ShouldHit)
-                {
-                    //m_ppuSprite0ShouldHit = false;
-                    m_ppuSprPixels[ppuBkgRenderPos] |= 0x4000;// Sprite 0
-                }
+        if(pixels[i] != 0 && (pixel & 3) == 0)
+            pixel = pixels[i];
 
-                if((m_ppuSprfetchAtData & 0x20) == 0)
-                    m_ppuSprPixels[ppuBkgRenderPos] |= 0x8000;
+        if(m_ppuSprfetchSlot == 0 && m_ppuSprite0ShouldHit)
+            pixel |= 0x4000;// Sprite 0
 
-                m_ppuSprfetchLbData <<= 1;
-                m_ppuSprfetchHbData <<= 1;
+        if((m_ppuSprfetchAtData & 0x20) == 0)
+            pixel |= 0x8000;
+    }
 
-                ppuBkgRenderPos++;
-            }
-        }
+    // the drawn bits got shifted out
+    if(flip)
+    {
+        m_ppuSprfetchLbData >>= count;
+        m_ppuSprfetchHbData >>= count;
     }
     else
     {
-        // H flip
-        for(auto i = 0; i < 8; i++)
-        {
-            if(ppuBkgRenderPos < 255)
-            {
-                const auto temp = ((m_ppuSprfetchAtData << 2) & 0xC) | (m_ppuSprfetchLbData & 1) | (m_ppuSprfetchHbData << 1 & 2);
-                if((temp & 3) && (m_ppuSprPixels[ppuBkgRenderPos] & 3) == 0)
-                    m_ppuSprPixels[ppuBkgRenderPos] = temp;
-
-                if(m_ppuSprfetchSlot == 0 && m_ppuSprite0ShouldHit)
-                {
-                    //m_ppuSprite0ShouldHit = false;
-                    m_ppuSprPixels[ppuBkgRenderPos] |= 0x4000;// Sprite 0
-                }
-
-                if((m_ppuSprfetchAtData & 0x20) == 0)
-                    m_ppuSprPixels[ppuBkgRenderPos] |= 0x8000;
-
-                m_ppuSprfetchLbData >>= 1;
-                m_ppuSprfetchHbData >>= 1;
-
-                ppuBkgRenderPos++;
-            }
-        }
+        m_ppuSprfetchLbData <<= count;
+        m_ppuSprfetchHbData <<= count;
     }
 }
 
@@ -617,11 +752,32 @@ void Ppu::oamPhase8()
 
 void Ppu::renderPixel()
 {
+    NESCORE_PROFILE_SCOPE(m_emu.profiler(), PpuRenderPixel);
+
     if(m_ppuClockV == EmuSettings::ppuClockVBlankEnd)
         return;
 
     const auto ppuRenderX = m_ppuClockH - 1;
+    const auto ppuCurrentPixel = mixPixel(ppuRenderX);
 
+    if((ppuCurrentPixel & 0x03) == 0)
+    {
+        const auto index1 = ppuRenderX + (m_ppuClockV * SCREEN_WIDTH);
+        const auto index2 = m_ppuPaletteBank[ppuCurrentPixel & 0x0C] & m_ppuColorAnd;
+        const auto value = EmuSettings::Video::palette[index2];
+        m_ppuScreenPixels[index1] = value;
+    }
+    else
+    {
+        const auto index1 = ppuRenderX + (m_ppuClockV * SCREEN_WIDTH);
+        const auto index2 = m_ppuPaletteBank[ppuCurrentPixel & 0x1F] & m_ppuColorAnd;
+        const auto value = EmuSettings::Video::palette[index2];
+        m_ppuScreenPixels[index1] = value;
+    }
+}
+
+int Ppu::mixPixel(int ppuRenderX)
+{
     int ppuBkgCurrentPixel;
     int ppuSprCurrentPixel;
 
@@ -653,45 +809,21 @@ void Ppu::renderPixel()
 
     }
 
-    int ppuCurrentPixel;
-
     if((ppuBkgCurrentPixel & 3) == 0)
-    {
-        ppuCurrentPixel = ppuSprCurrentPixel;
-        goto render;
-    }
+        return ppuSprCurrentPixel;
 
     if((ppuSprCurrentPixel & 3) == 0)
-    {
-        ppuCurrentPixel = ppuBkgCurrentPixel;
-        goto render;
-    }
-
-    // Use priority
-    if(m_ppuSprPixels[ppuRenderX] & 0x8000)
-        ppuCurrentPixel = ppuSprCurrentPixel;
-    else
-        ppuCurrentPixel = ppuBkgCurrentPixel;
+        return ppuBkgCurrentPixel;
 
     // Sprite 0 Hit
     if(m_ppuSprPixels[ppuRenderX] & 0x4000)
         m_ppuReg2002Sprite0Hit = true;
 
-render:
-    if((ppuCurrentPixel & 0x03) == 0)
-    {
-        const auto index1 = ppuRenderX + (m_ppuClockV * SCREEN_WIDTH);
-        const auto index2 = m_ppuPaletteBank[ppuCurrentPixel & 0x0C] & m_ppuColorAnd;
-        const auto value = EmuSettings::Video::palette[index2];
-        m_ppuScreenPixels[index1] = value;
-    }
+    // Use priority
+    if(m_ppuSprPixels[ppuRenderX] & 0x8000)
+        return ppuSprCurrentPixel;
     else
-    {
-        const auto index1 = ppuRenderX + (m_ppuClockV * SCREEN_WIDTH);
-        const auto index2 = m_ppuPaletteBank[ppuCurrentPixel & 0x1F] & m_ppuColorAnd;
-        const auto value = EmuSettings::Video::palette[index2];
-        m_ppuScreenPixels[index1] = value;
-    }
+        return ppuBkgCurrentPixel;
 }
 
 quint8 Ppu::_ioRead(const quint16 address)
@@ -847,7 +979,11 @@ void Ppu::onRegister2006()
     {
         m_ppuVramAddrTemp = (m_ppuVramAddrTemp & 0x7F00) | m_ppuRegIoDb;
         m_ppuVramAddr = m_ppuVramAddrTemp;
-        m_emu.memory().board()->onPpuAddressUpdate(m_ppuVramAddr);
+        if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+        {
+            NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+            m_emu.memory().board()->onPpuAddressUpdate(m_ppuVramAddr);
+        }
     }
 
     m_ppuVramFlipFlop = !m_ppuVramFlipFlop;
@@ -888,7 +1024,11 @@ void Ppu::onRegister2007()
     }
 
     m_ppuVramAddr = (m_ppuVramAddr + m_ppuReg2000VramAddressIncreament) & 0x7FFF;
-    m_emu.memory().board()->onPpuAddressUpdate(m_ppuVramAddr);
+    if(m_emu.memory().boardHooked(Board::HookPpuAddressUpdate))
+    {
+        NESCORE_PROFILE_SCOPE(m_emu.profiler(), BoardPpuAddressUpdate);
+        m_emu.memory().board()->onPpuAddressUpdate(m_ppuVramAddr);
+    }
 }
 
 void Ppu::read2000()
@@ -951,33 +1091,96 @@ bool Ppu::isInRender() const
     return m_ppuClockV < SCREEN_HEIGHT || m_ppuClockV == EmuSettings::ppuClockVBlankEnd;
 }
 
-void Ppu::readState(QDataStream &dataStream)
+bool Ppu::regAccessHappened() const
 {
-    dataStream >> m_ppuClockH >> m_ppuClockV >> m_ppuUseOddSwap >> m_ppuIsNmiTime >> m_ppuOamBank >> m_ppuOamBankSecondary >> m_ppuPaletteBank >> m_ppuRegIoDb
-               >> m_ppuRegIoAddr >> m_ppuRegAccessHappened >> m_ppuRegAccessW >> m_ppuReg2000VramAddressIncreament >> m_ppuReg2000SpritePatternTableAddressFor8x8Sprites
-               >> m_ppuReg2000BackgroundPatternTableAddress >> m_ppuReg2000SpriteSize >> m_ppuReg2000Vbi >> m_ppuReg2001ShowBackgroundInLeftmost8PixelsOfScreen
-               >> m_ppuReg2001ShowSpritesInLeftmost8PixelsOfScreen >> m_ppuReg2001ShowBackground >> m_ppuReg2001ShowSprites >> m_ppuReg2001Grayscale >> m_ppuReg2001Emphasis
-               >> m_ppuReg2002SpriteOverflow >> m_ppuReg2002Sprite0Hit >> m_ppuReg2002VblankStartedFlag >> m_ppuReg2003OamAddr >> m_ppuVramAddr >> m_ppuVramData >> m_ppuVramAddrTemp
-               >> m_ppuVramAddrAccessTemp >> m_ppuVramFlipFlop >> m_ppuVramFinex >> m_ppuBkgfetchNtAddr >> m_ppuBkgfetchNtData >> m_ppuBkgfetchAtAddr >> m_ppuBkgfetchAtData
-               >> m_ppuBkgfetchLbAddr >> m_ppuBkgfetchLbData >> m_ppuBkgfetchHbAddr >> m_ppuBkgfetchHbData >> m_ppuSprfetchSlot >> m_ppuSprfetchYData >> m_ppuSprfetchTData
-               >> m_ppuSprfetchAtData >> m_ppuSprfetchXData >> m_ppuSprfetchLbAddr >> m_ppuSprfetchLbData >> m_ppuSprfetchHbAddr >> m_ppuSprfetchHbData >> m_ppuColorAnd
-               >> m_ppuOamEvN >> m_ppuOamEvM >> m_ppuOamevCompare >> m_ppuOamevSlot >> m_ppuFetchData >> m_ppuPhaseIndex >> m_ppuSprite0ShouldHit;
+    return m_ppuRegAccessHappened;
 }
 
-void Ppu::writeState(QDataStream &dataStream) const
+qint32 Ppu::clocksUntilEvent() const
 {
-    dataStream << m_ppuClockH << m_ppuClockV << m_ppuUseOddSwap << m_ppuIsNmiTime << m_ppuOamBank << m_ppuOamBankSecondary << m_ppuPaletteBank << m_ppuRegIoDb
-               << m_ppuRegIoAddr << m_ppuRegAccessHappened << m_ppuRegAccessW << m_ppuReg2000VramAddressIncreament << m_ppuReg2000SpritePatternTableAddressFor8x8Sprites
-               << m_ppuReg2000BackgroundPatternTableAddress << m_ppuReg2000SpriteSize << m_ppuReg2000Vbi << m_ppuReg2001ShowBackgroundInLeftmost8PixelsOfScreen
-               << m_ppuReg2001ShowSpritesInLeftmost8PixelsOfScreen << m_ppuReg2001ShowBackground << m_ppuReg2001ShowSprites << m_ppuReg2001Grayscale << m_ppuReg2001Emphasis
-               << m_ppuReg2002SpriteOverflow << m_ppuReg2002Sprite0Hit << m_ppuReg2002VblankStartedFlag << m_ppuReg2003OamAddr << m_ppuVramAddr << m_ppuVramData << m_ppuVramAddrTemp
-               << m_ppuVramAddrAccessTemp << m_ppuVramFlipFlop << m_ppuVramFinex << m_ppuBkgfetchNtAddr << m_ppuBkgfetchNtData << m_ppuBkgfetchAtAddr << m_ppuBkgfetchAtData
-               << m_ppuBkgfetchLbAddr << m_ppuBkgfetchLbData << m_ppuBkgfetchHbAddr << m_ppuBkgfetchHbData << m_ppuSprfetchSlot << m_ppuSprfetchYData << m_ppuSprfetchTData
-               << m_ppuSprfetchAtData << m_ppuSprfetchXData << m_ppuSprfetchLbAddr << m_ppuSprfetchLbData << m_ppuSprfetchHbAddr << m_ppuSprfetchHbData << m_ppuColorAnd
-               << m_ppuOamEvN << m_ppuOamEvM << m_ppuOamevCompare << m_ppuOamevSlot << m_ppuFetchData << m_ppuPhaseIndex << m_ppuSprite0ShouldHit;
+    // Number of ppu clocks that can be run without the cpu side being able to tell when exactly
+    // they happened (as long as no register gets accessed). Events are the nmi edge at the start
+    // of vblank and the end of the frame (including the odd cycle skip).
+    constexpr qint32 vblankStart = EmuSettings::ppuClockVBlankStart * 341 + 1;
+    constexpr qint32 vblankStartEnd = vblankStart + 3;
+    constexpr qint32 frameEnd = EmuSettings::ppuClockVBlankEnd * 341 + (EmuSettings::ppuUseOddCycle ? 339 : 340);
+
+    const qint32 position = m_ppuClockV * 341 + m_ppuClockH;
+
+    if(position < vblankStart)
+        return vblankStart - position;
+    if(position <= vblankStartEnd)
+        return 0;
+    if(position < frameEnd)
+        return frameEnd - position;
+    return 0;
+}
+
+bool Ppu::fastScanlinesEnabled() const
+{
+    return m_fastScanlinesEnabled;
+}
+
+void Ppu::setFastScanlinesEnabled(bool fastScanlinesEnabled)
+{
+    m_fastScanlinesEnabled = fastScanlinesEnabled;
+}
+
+quint64 Ppu::fastScanlines() const
+{
+    return m_fastScanlines;
+}
+
+quint64 Ppu::dotScanlines() const
+{
+    return m_dotScanlines;
+}
+
+Ppu::Statistics Ppu::statistics() const
+{
+    return Statistics { m_fastScanlines, m_dotScanlines };
+}
+
+void Ppu::setStatistics(const Statistics &statistics)
+{
+    m_fastScanlines = statistics.fastScanlines;
+    m_dotScanlines = statistics.dotScanlines;
+}
+
+void Ppu::readState(SnapshotReader &snapshot)
+{
+    snapshot >> m_ppuClockH >> m_ppuClockV >> m_ppuUseOddSwap >> m_ppuIsNmiTime >> m_ppuOamBank >> m_ppuOamBankSecondary >> m_ppuPaletteBank >> m_ppuRegIoDb
+             >> m_ppuRegIoAddr >> m_ppuRegAccessHappened >> m_ppuRegAccessW >> m_ppuReg2000VramAddressIncreament >> m_ppuReg2000SpritePatternTableAddressFor8x8Sprites
+             >> m_ppuReg2000BackgroundPatternTableAddress >> m_ppuReg2000SpriteSize >> m_ppuReg2000Vbi >> m_ppuReg2001ShowBackgroundInLeftmost8PixelsOfScreen
+             >> m_ppuReg2001ShowSpritesInLeftmost8PixelsOfScreen >> m_ppuReg2001ShowBackground >> m_ppuReg2001ShowSprites >> m_ppuReg2001Grayscale >> m_ppuReg2001Emphasis
+             >> m_ppuReg2002SpriteOverflow >> m_ppuReg2002Sprite0Hit >> m_ppuReg2002VblankStartedFlag >> m_ppuReg2003OamAddr >> m_ppuVramAddr >> m_ppuVramData >> m_ppuVramAddrTemp
+             >> m_ppuVramAddrAccessTemp >> m_ppuVramFlipFlop >> m_ppuVramFinex >> m_ppuBkgfetchNtAddr >> m_ppuBkgfetchNtData >> m_ppuBkgfetchAtAddr >> m_ppuBkgfetchAtData
+             >> m_ppuBkgfetchLbAddr >> m_ppuBkgfetchLbData >> m_ppuBkgfetchHbAddr >> m_ppuBkgfetchHbData >> m_ppuSprfetchSlot >> m_ppuSprfetchYData >> m_ppuSprfetchTData
+             >> m_ppuSprfetchAtData >> m_ppuSprfetchXData >> m_ppuSprfetchLbAddr >> m_ppuSprfetchLbData >> m_ppuSprfetchHbAddr >> m_ppuSprfetchHbData >> m_ppuColorAnd
+             >> m_ppuOamEvN >> m_ppuOamEvM >> m_ppuOamevCompare >> m_ppuOamevSlot >> m_ppuFetchData >> m_ppuPhaseIndex >> m_ppuSprite0ShouldHit
+             >> m_ppuIsSprfetch >> m_ppuBkgPixels >> m_ppuSprPixels;
+}
+
+void Ppu::writeState(SnapshotWriter &snapshot) const
+{
+    snapshot << m_ppuClockH << m_ppuClockV << m_ppuUseOddSwap << m_ppuIsNmiTime << m_ppuOamBank << m_ppuOamBankSecondary << m_ppuPaletteBank << m_ppuRegIoDb
+             << m_ppuRegIoAddr << m_ppuRegAccessHappened << m_ppuRegAccessW << m_ppuReg2000VramAddressIncreament << m_ppuReg2000SpritePatternTableAddressFor8x8Sprites
+             << m_ppuReg2000BackgroundPatternTableAddress << m_ppuReg2000SpriteSize << m_ppuReg2000Vbi << m_ppuReg2001ShowBackgroundInLeftmost8PixelsOfScreen
+             << m_ppuReg2001ShowSpritesInLeftmost8PixelsOfScreen << m_ppuReg2001ShowBackground << m_ppuReg2001ShowSprites << m_ppuReg2001Grayscale << m_ppuReg2001Emphasis
+             << m_ppuReg2002SpriteOverflow << m_ppuReg2002Sprite0Hit << m_ppuReg2002VblankStartedFlag << m_ppuReg2003OamAddr << m_ppuVramAddr << m_ppuVramData << m_ppuVramAddrTemp
+             << m_ppuVramAddrAccessTemp << m_ppuVramFlipFlop << m_ppuVramFinex << m_ppuBkgfetchNtAddr << m_ppuBkgfetchNtData << m_ppuBkgfetchAtAddr << m_ppuBkgfetchAtData
+             << m_ppuBkgfetchLbAddr << m_ppuBkgfetchLbData << m_ppuBkgfetchHbAddr << m_ppuBkgfetchHbData << m_ppuSprfetchSlot << m_ppuSprfetchYData << m_ppuSprfetchTData
+             << m_ppuSprfetchAtData << m_ppuSprfetchXData << m_ppuSprfetchLbAddr << m_ppuSprfetchLbData << m_ppuSprfetchHbAddr << m_ppuSprfetchHbData << m_ppuColorAnd
+             << m_ppuOamEvN << m_ppuOamEvM << m_ppuOamevCompare << m_ppuOamevSlot << m_ppuFetchData << m_ppuPhaseIndex << m_ppuSprite0ShouldHit
+             << m_ppuIsSprfetch << m_ppuBkgPixels << m_ppuSprPixels;
 }
 
 const std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &Ppu::screenPixels() const
 {
     return m_ppuScreenPixels;
 }
+
+void Ppu::setScreenPixels(const std::array<qint32, SCREEN_WIDTH*SCREEN_HEIGHT> &screenPixels)
+{
+    m_ppuScreenPixels = screenPixels;
+}
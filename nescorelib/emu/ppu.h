@@ -1,7 +1,6 @@
 #pragma once
 
 #include "nescorelib_global.h"
-#include <QObject>
 
 // Qt includes
 #include <QtGlobal>
@@ -11,11 +10,12 @@
 
 // forward declarations
 class NesEmulator;
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 
-class NESCORELIB_EXPORT Ppu : public QObject
+class NESCORELIB_EXPORT Ppu
 {
-    Q_OBJECT
+    Q_DISABLE_COPY(Ppu)
 
 public:
     static constexpr quint32 SCREEN_WIDTH = 256;
@@ -28,6 +28,8 @@ public:
 
     // scanlines
     void scanlineRender();
+    bool scanlineFastPossible() const;
+    void scanlineRenderFast();
     void scanlineVBlankStart();
     void scanlineVBlankEnd();
     void scanlineVBlank();
@@ -41,6 +43,13 @@ public:
     void bkgFetch5();
     void bkgFetch6();
     void bkgFetch7();
+    void bkgRenderTile(int ppuBkgRenderPos);
+    void bkgIncrementX();
+    void bkgIncrementY();
+
+    // pattern and nametable reads, directly from the board pages where possible
+    quint8 fetchChr(quint16 address);
+    quint8 fetchNmt(quint16 address);
 
     // spr fetches
     void sprFetch0();
@@ -63,6 +72,7 @@ public:
     void oamPhase8();
 
     void renderPixel();
+    int mixPixel(int ppuRenderX);
 
     // io
     quint8 _ioRead(const quint16 address);
@@ -89,13 +99,31 @@ public:
     bool isRenderingOn() const;
     bool isInRender() const;
 
-    void readState(QDataStream &dataStream);
-    void writeState(QDataStream &dataStream) const;
+    bool regAccessHappened() const;
+    qint32 clocksUntilEvent() const;
+
+    bool fastScanlinesEnabled() const;
+    void setFastScanlinesEnabled(bool fastScanlinesEnabled);
+
+    quint64 fastScanlines() const;
+    quint64 dotScanlines() const;
+
+    // What the ppu counted so far, not part of the state
+    struct Statistics {
+        quint64 fastScanlines {};
+        quint64 dotScanlines {};
+    };
+    Statistics statistics() const;
+    void setStatistics(const Statistics &statistics);
+
+    void readState(SnapshotReader &snapshot);
+    void writeState(SnapshotWriter &snapshot) const;
 
     const std::array<qint32, SCREEN_WIDTH*SCREEN_HEIGHT> &screenPixels() const;
 
-Q_SIGNALS:
-    void frameFinished(const std::array<qint32, SCREEN_WIDTH*SCREEN_HEIGHT> &frame);
+    // The framebuffer is not part of the state. A few pixels get drawn after the end of the
+    // frame, restoring a state puts back the picture they belong to with this.
+    void setScreenPixels(const std::array<qint32, SCREEN_WIDTH*SCREEN_HEIGHT> &screenPixels);
 
 private:
     NesEmulator &m_emu;
@@ -184,4 +212,9 @@ private:
     quint8 m_ppuFetchData {};
     quint8 m_ppuPhaseIndex {};
     bool m_ppuSprite0ShouldHit {};
+
+    // Scanline statistics
+    bool m_fastScanlinesEnabled { true };
+    quint64 m_fastScanlines {};
+    quint64 m_dotScanlines {};
 };
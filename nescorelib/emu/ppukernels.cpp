@@ -0,0 +1,133 @@
+#include "ppukernels.h"
+
+// system includes
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define PPUKERNELS_SSE2
+#endif
+
+// local includes
+#include "emusettings.h"
+
+namespace {
+// Multiplying a byte with this repeats it in all 8 bytes of a 64 bit word.
+constexpr quint64 broadcast = 0x0101010101010101ULL;
+
+// Byte n selects the bit of pixel n: msb first for normal tiles, lsb first for flipped ones.
+constexpr quint64 pixelBits = 0x0102040810204080ULL;
+constexpr quint64 pixelBitsFlipped = 0x8040201008040201ULL;
+
+quint64 decodeSwar(quint8 low, quint8 high, quint8 attribute, quint64 bits)
+{
+    // 0x01 in every byte whose bit is set
+    const auto lowBits = ((((low * broadcast) & bits) + 0x7F7F7F7F7F7F7F7FULL) >> 7) & broadcast;
+    const auto highBits = ((((high * broadcast) & bits) + 0x7F7F7F7F7F7F7F7FULL) >> 7) & broadcast;
+
+    const auto colors = lowBits | (highBits << 1);
+    const auto opaque = (((colors + 0x7F7F7F7F7F7F7F7FULL) >> 7) & broadcast) * 0xFF;
+
+    return colors | (attribute * broadcast & opaque);
+}
+}
+
+void PpuKernels::decodeTileRow(quint8 low, quint8 high, quint8 attribute, bool flip, quint8 *pixels)
+{
+    const auto row = decodeSwar(low, high, attribute, flip ? pixelBitsFlipped : pixelBits);
+    std::memcpy(pixels, &row, sizeof(row));
+}
+
+void PpuKernels::decodeTileRows(const quint8 *low, const quint8 *high, const quint8 *attributes, int count, quint8 *pixels)
+{
+    auto i = 0;
+
+#if defined(__AVX2__)
+    const auto bits = _mm256_set1_epi64x(qint64(pixelBits));
+    const auto one = _mm256_set1_epi8(1);
+    const auto two = _mm256_set1_epi8(2);
+    const auto zero = _mm256_setzero_si256();
+
+    for(; i + 4 <= count; i += 4)
+    {
+        const auto lowRows = _mm256_set_epi64x(qint64(low[i+3] * broadcast), qint64(low[i+2] * broadcast),
+                                               qint64(low[i+1] * broadcast), qint64(low[i] * broadcast));
+        const auto highRows = _mm256_set_epi64x(qint64(high[i+3] * broadcast), qint64(high[i+2] * broadcast),
+                                                qint64(high[i+1] * broadcast), qint64(high[i] * broadcast));
+        const auto attributeRows = _mm256_set_epi64x(qint64(attributes[i+3] * broadcast), qint64(attributes[i+2] * broadcast),
+                                                     qint64(attributes[i+1] * broadcast), qint64(attributes[i] * broadcast));
+
+        const auto lowSet = _mm256_cmpeq_epi8(_mm256_and_si256(lowRows, bits), bits);
+        const auto highSet = _mm256_cmpeq_epi8(_mm256_and_si256(highRows, bits), bits);
+
+        const auto colors = _mm256_or_si256(_mm256_and_si256(lowSet, one), _mm256_and_si256(highSet, two));
+        const auto transparent = _mm256_cmpeq_epi8(colors, zero);
+        const auto result = _mm256_or_si256(colors, _mm256_andnot_si256(transparent, attributeRows));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(pixels + i * 8), result);
+    }
+#elif defined(PPUKERNELS_SSE2)
+    const auto bits = _mm_set1_epi64x(qint64(pixelBits));
+    const auto one = _mm_set1_epi8(1);
+    const auto two = _mm_set1_epi8(2);
+    const auto zero = _mm_setzero_si128();
+
+    for(; i + 2 <= count; i += 2)
+    {
+        const auto lowRows = _mm_set_epi64x(qint64(low[i+1] * broadcast), qint64(low[i] * broadcast));
+        const auto highRows = _mm_set_epi64x(qint64(high[i+1] * broadcast), qint64(high[i] * broadcast));
+        const auto attributeRows = _mm_set_epi64x(qint64(attributes[i+1] * broadcast), qint64(attributes[i] * broadcast));
+
+        const auto lowSet = _mm_cmpeq_epi8(_mm_and_si128(lowRows, bits), bits);
+        const auto highSet = _mm_cmpeq_epi8(_mm_and_si128(highRows, bits), bits);
+
+        const auto colors = _mm_or_si128(_mm_and_si128(lowSet, one), _mm_and_si128(highSet, two));
+        const auto transparent = _mm_cmpeq_epi8(colors, zero);
+        const auto result = _mm_or_si128(colors, _mm_andnot_si128(transparent, attributeRows));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i * 8), result);
+    }
+#endif
+
+    for(; i < count; i++)
+        decodeTileRow(low[i], high[i], attributes[i], false, pixels + i * 8);
+}
+
+void PpuKernels::buildPaletteLut(const std::array<quint8, 32> &paletteBank, qint32 colorAnd, std::array<qint32, 32> &lut)
+{
+    for(std::size_t i = 0; i < lut.size(); i++)
+    {
+        // the transparent entries of all palettes mirror the backdrop ones
+        const auto index = (i & 0x03) ? i : (i & 0x0C);
+        lut[i] = EmuSettings::Video::palette[paletteBank[index] & colorAnd];
+    }
+}
+
+void PpuKernels::lookupPalette(const quint8 *addresses, int count, const std::array<qint32, 32> &lut, qint32 *colors)
+{
+    auto i = 0;
+
+#if defined(__AVX2__)
+    for(; i + 8 <= count; i += 8)
+    {
+        const auto indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(addresses + i)));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(colors + i), _mm256_i32gather_epi32(lut.data(), indices, 4));
+    }
+#endif
+
+    for(; i < count; i++)
+        colors[i] = lut[addresses[i] & 0x1F];
+}
+
+const char *PpuKernels::instructionSet()
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(PPUKERNELS_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
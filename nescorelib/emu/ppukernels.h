@@ -0,0 +1,31 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <array>
+
+// Pixel kernels used by the ppu scanline renderers. Depending on the build flags these use
+// AVX2 or SSE2, otherwise a portable 64 bit SWAR fallback.
+namespace PpuKernels
+{
+    // Combines one 8 pixel tile row from the low and high bitplane bytes. Every output byte
+    // is the 2 bit color with the 2 attribute bits on top, or 0 for a transparent pixel.
+    // attribute is already shifted into place (0x0 - 0xC).
+    NESCORELIB_EXPORT void decodeTileRow(quint8 low, quint8 high, quint8 attribute, bool flip, quint8 *pixels);
+
+    // Same as decodeTileRow() for count consecutive (unflipped) tiles, writing count*8 pixels.
+    NESCORELIB_EXPORT void decodeTileRows(const quint8 *low, const quint8 *high, const quint8 *attributes, int count, quint8 *pixels);
+
+    // Resolves all 32 palette ram addresses to their final ARGB colors, so that a span can be
+    // converted with one lookup per pixel.
+    NESCORELIB_EXPORT void buildPaletteLut(const std::array<quint8, 32> &paletteBank, qint32 colorAnd, std::array<qint32, 32> &lut);
+
+    // Converts count palette ram addresses (0x00 - 0x1F) into ARGB colors.
+    NESCORELIB_EXPORT void lookupPalette(const quint8 *addresses, int count, const std::array<qint32, 32> &lut, qint32 *colors);
+
+    NESCORELIB_EXPORT const char *instructionSet();
+}
@@ -0,0 +1,192 @@
+#include "emulatorpool.h"
+
+// system includes
+#include <algorithm>
+
+// local includes
+#include "rom.h"
+
+EmulatorPool::EmulatorPool(int threadCount)
+{
+    threadCount = std::max(threadCount, 1);
+
+    for(auto i = 0; i < threadCount; i++)
+        m_workers.push_back(std::make_unique<Worker>());
+
+    for(std::size_t i = 0; i < m_workers.size(); i++)
+        m_workers[i]->thread = std::thread(&EmulatorPool::work, this, i);
+}
+
+EmulatorPool::~EmulatorPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_quit = true;
+    }
+    m_startCondition.notify_all();
+
+    for(auto &worker : m_workers)
+        worker->thread.join();
+}
+
+std::size_t EmulatorPool::addInstance(const Rom &rom)
+{
+    auto emulator = std::make_unique<NesEmulator>();
+    emulator->load(rom);
+    m_instances.push_back(std::move(emulator));
+    return m_instances.size() - 1;
+}
+
+std::size_t EmulatorPool::instanceCount() const
+{
+    return m_instances.size();
+}
+
+NesEmulator &EmulatorPool::instance(std::size_t index)
+{
+    return *m_instances[index];
+}
+
+const NesEmulator &EmulatorPool::instance(std::size_t index) const
+{
+    return *m_instances[index];
+}
+
+void EmulatorPool::runFrames(quint64 frames)
+{
+    if(!frames || m_instances.empty())
+        return;
+
+    m_pendingInstances = m_instances.size();
+
+    // spread the instances round robin, stealing evens out the rest
+    for(std::size_t i = 0; i < m_instances.size(); i++)
+        pushJob(i % m_workers.size(), { i, frames });
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_generation++;
+    m_startCondition.notify_all();
+
+    m_doneCondition.wait(lock, [this](){ return m_pendingInstances == 0; });
+}
+
+const std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &EmulatorPool::screenPixels(std::size_t index) const
+{
+    return m_instances[index]->ppu().screenPixels();
+}
+
+std::size_t EmulatorPool::readSamples(std::size_t index, qint32 *samples, std::size_t count)
+{
+    return m_instances[index]->apu().readSamples(samples, count);
+}
+
+int EmulatorPool::threadCount() const
+{
+    return m_workers.size();
+}
+
+quint64 EmulatorPool::batchFrames() const
+{
+    return m_batchFrames;
+}
+
+void EmulatorPool::setBatchFrames(quint64 batchFrames)
+{
+    m_batchFrames = std::max<quint64>(batchFrames, 1);
+}
+
+void EmulatorPool::work(std::size_t worker)
+{
+    quint64 generation {};
+
+    forever
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_startCondition.wait(lock, [this, &generation](){ return m_quit || m_generation != generation; });
+            if(m_quit)
+                return;
+            generation = m_generation;
+        }
+
+        Job job;
+        while(m_pendingInstances > 0)
+        {
+            if(!popJob(worker, job))
+            {
+                // the remaining jobs are running on other workers, sleep until one of them
+                // queues its next batch
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_idleWorkers++;
+                m_workCondition.wait(lock, [this](){ return m_queuedJobs > 0 || m_pendingInstances == 0; });
+                m_idleWorkers--;
+                continue;
+            }
+
+            const auto frames = std::min(job.frames, m_batchFrames);
+            auto &emulator = *m_instances[job.instance];
+            for(quint64 i = 0; i < frames; i++)
+                emulator.emuClockFrame();
+
+            job.frames -= frames;
+            if(job.frames)
+                pushJob(worker, job);
+            else if(--m_pendingInstances == 0)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_doneCondition.notify_all();
+                m_workCondition.notify_all();
+            }
+        }
+    }
+}
+
+bool EmulatorPool::popJob(std::size_t worker, Job &job)
+{
+    // own jobs are taken from the back, they are most likely still in the cache
+    {
+        auto &own = *m_workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if(!own.jobs.empty())
+        {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            m_queuedJobs--;
+            return true;
+        }
+    }
+
+    // steal from the front of the others
+    for(std::size_t i = 1; i < m_workers.size(); i++)
+    {
+        auto &victim = *m_workers[(worker + i) % m_workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if(!victim.jobs.empty())
+        {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            m_queuedJobs--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void EmulatorPool::pushJob(std::size_t worker, const Job &job)
+{
+    {
+        auto &own = *m_workers[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.jobs.push_back(job);
+    }
+
+    // counted after the job is visible, a woken worker must find it. A worker that becomes
+    // idle after the check below sees the count before it sleeps.
+    m_queuedJobs++;
+    if(m_idleWorkers > 0)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workCondition.notify_one();
+    }
+}
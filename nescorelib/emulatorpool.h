@@ -0,0 +1,82 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// local includes
+#include "nesemulator.h"
+
+// forward declarations
+struct Rom;
+
+// Owns many independent emulators and runs their frames on a work stealing thread pool.
+// Every worker has its own queue of (instance, frame batch) jobs, a finished batch queues
+// the next batch of the same instance locally and idle workers steal from the others.
+// Callbacks set on an instance get invoked on whichever worker runs it.
+class NESCORELIB_EXPORT EmulatorPool
+{
+    Q_DISABLE_COPY(EmulatorPool)
+
+public:
+    explicit EmulatorPool(int threadCount = int(std::thread::hardware_concurrency()));
+    ~EmulatorPool();
+
+    std::size_t addInstance(const Rom &rom);
+    std::size_t instanceCount() const;
+    NesEmulator &instance(std::size_t index);
+    const NesEmulator &instance(std::size_t index) const;
+
+    // Emulates frames frames on every instance, returns once all of them are done
+    void runFrames(quint64 frames);
+
+    const std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &screenPixels(std::size_t index) const;
+    std::size_t readSamples(std::size_t index, qint32 *samples, std::size_t count);
+
+    int threadCount() const;
+
+    // How many frames a worker runs on an instance before it looks for other work again
+    quint64 batchFrames() const;
+    void setBatchFrames(quint64 batchFrames);
+
+private:
+    struct Job {
+        std::size_t instance;
+        quint64 frames; // still to run on this instance, including this batch
+    };
+
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    void work(std::size_t worker);
+    bool popJob(std::size_t worker, Job &job);
+    void pushJob(std::size_t worker, const Job &job);
+
+    std::vector<std::unique_ptr<NesEmulator> > m_instances;
+    std::vector<std::unique_ptr<Worker> > m_workers;
+
+    quint64 m_batchFrames { 8 };
+
+    std::mutex m_mutex;
+    std::condition_variable m_startCondition;
+    std::condition_variable m_doneCondition;
+    std::condition_variable m_workCondition; // a job got queued or the last one finished
+    quint64 m_generation {}; // bumped for every runFrames()
+    bool m_quit {};
+    std::atomic<std::size_t> m_pendingInstances {};
+    std::atomic<std::size_t> m_queuedJobs {};
+    std::atomic<int> m_idleWorkers {}; // waiting on m_workCondition
+};
@@ -16,10 +16,17 @@ namespace EmuSettings
 
     constexpr quint16 ppuClockVBlankStart = region == EmuRegion::DENDY ? 291 : 241;
     constexpr quint16 ppuClockVBlankEnd = region == EmuRegion::NTSC ? 261 : 311;
+
+    // Hz, cpu cycles of a frame at the target fps. The ppu runs 3 dots per cpu cycle in every
+    // region, the apu gets clocked once per cpu cycle.
+    constexpr double cpuClockRate = (ppuClockVBlankEnd + 1) * 341 / 3. * emuTimeTargetFps;
     constexpr bool ppuUseOddCycle = region == EmuRegion::NTSC;
 
     constexpr bool frameLimiterEnabled = false;
 
+    // Frames the frontend presents ahead of the emulated one to hide input lag, see RunAhead
+    constexpr int runAheadFrames = 0;
+
     namespace Video
     {
         constexpr float saturation = 2.0f;
@@ -129,6 +136,9 @@ namespace EmuSettings
         constexpr int internalAmplitude = 285;
         constexpr int internalPeekLimit = 124;
 
+        // Milliseconds of samples the frontend keeps buffered ahead of the audio device
+        constexpr int targetLatency = 100;
+
         namespace ChannelEnabled
         {
             constexpr bool SQ1 = true;
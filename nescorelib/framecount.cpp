@@ -0,0 +1,22 @@
+#include "framecount.h"
+
+// Qt includes
+#include <QDataStream>
+#include <QIODevice>
+
+// system includes
+#include <stdexcept>
+
+quint32 readFrameCount(QDataStream &dataStream, std::size_t frameSize)
+{
+    quint32 frameCount;
+    dataStream >> frameCount;
+    if(dataStream.status() != QDataStream::Ok)
+        throw std::runtime_error("wrong header");
+
+    const auto *device = dataStream.device();
+    if(frameCount * quint64(frameSize) > quint64(device->size() - device->pos()))
+        throw std::runtime_error("file is too short for its frame count");
+
+    return frameCount;
+}
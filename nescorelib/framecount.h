@@ -0,0 +1,17 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <cstddef>
+
+// forward declarations
+class QDataStream;
+
+// Reads the 32 bit frame count of a file storing frameSize bytes per frame after it. The
+// count gets checked against the bytes left in the file before anything is allocated for
+// the frames, a broken count must not reserve gigabytes. Throws std::runtime_error.
+NESCORELIB_EXPORT quint32 readFrameCount(QDataStream &dataStream, std::size_t frameSize);
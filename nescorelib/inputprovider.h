@@ -5,6 +5,8 @@
 class InputProvider
 {
 public:
+    virtual ~InputProvider() = default;
+
     virtual void update() = 0;
     virtual quint8 getData() const = 0;
 };
@@ -9,3 +9,8 @@ quint8 Mapper000::mapper() const
 {
     return 0;
 }
+
+quint32 Mapper000::hooks() const
+{
+    return HookNone;
+}
@@ -10,4 +10,5 @@ public:
 
     QString name() const Q_DECL_OVERRIDE;
     quint8 mapper() const Q_DECL_OVERRIDE;
+    quint32 hooks() const Q_DECL_OVERRIDE;
 };
@@ -1,6 +1,7 @@
 #include "mapper001.h"
 
-#include "utils/datastreamutils.h"
+// local includes
+#include "snapshot.h"
 
 QString Mapper001::name() const
 {
@@ -12,6 +13,10 @@ quint8 Mapper001::mapper() const
     return 1;
 }
 
+quint32 Mapper001::hooks() const
+{
+    return HookCpuClock;
+}
 
 void Mapper001::hardReset()
 {
@@ -156,18 +161,18 @@ void Mapper001::onCpuClock()
         m_cpuCycles--;
 }
 
-void Mapper001::readState(QDataStream &dataStream)
+void Mapper001::readState(SnapshotReader &snapshot)
 {
-    Board::readState(dataStream);
-    dataStream >> m_reg >> m_shift >> m_buffer >> m_flagP >> m_flagC >> m_flagS >> m_enableWramEnable
-               >> m_prgHijackedBit >> m_useHijacked >> m_useSramSwitch >> m_cpuCycles;
+    Board::readState(snapshot);
+    snapshot >> m_reg >> m_shift >> m_buffer >> m_flagP >> m_flagC >> m_flagS >> m_enableWramEnable
+             >> m_prgHijackedBit >> m_useHijacked >> m_useSramSwitch >> m_cpuCycles;
 }
 
-void Mapper001::writeState(QDataStream &dataStream) const
+void Mapper001::writeState(SnapshotWriter &snapshot) const
 {
-    Board::writeState(dataStream);
-    dataStream << m_reg << m_shift << m_buffer << m_flagP << m_flagC << m_flagS << m_enableWramEnable
-               << m_prgHijackedBit << m_useHijacked << m_useSramSwitch << m_cpuCycles;
+    Board::writeState(snapshot);
+    snapshot << m_reg << m_shift << m_buffer << m_flagP << m_flagC << m_flagS << m_enableWramEnable
+             << m_prgHijackedBit << m_useHijacked << m_useSramSwitch << m_cpuCycles;
 }
 
 int Mapper001::prgRam8KbDefaultBlkCount() const
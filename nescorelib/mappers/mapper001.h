@@ -10,12 +10,13 @@ public:
 
     QString name() const Q_DECL_OVERRIDE;
     quint8 mapper() const Q_DECL_OVERRIDE;
+    quint32 hooks() const Q_DECL_OVERRIDE;
 
     void hardReset() Q_DECL_OVERRIDE;
     void writePrg(quint16 address, quint8 value) Q_DECL_OVERRIDE;
     void onCpuClock() Q_DECL_OVERRIDE;
-    void readState(QDataStream &dataStream) Q_DECL_OVERRIDE;
-    void writeState(QDataStream &dataStream) const Q_DECL_OVERRIDE;
+    void readState(SnapshotReader &snapshot) Q_DECL_OVERRIDE;
+    void writeState(SnapshotWriter &snapshot) const Q_DECL_OVERRIDE;
 
 protected:
     int prgRam8KbDefaultBlkCount() const Q_DECL_OVERRIDE;
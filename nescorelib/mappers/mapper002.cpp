@@ -10,6 +10,11 @@ quint8 Mapper002::mapper() const
     return 2;
 }
 
+quint32 Mapper002::hooks() const
+{
+    return HookNone;
+}
+
 void Mapper002::hardReset()
 {
     Board::hardReset();
@@ -10,6 +10,7 @@ public:
 
     QString name() const Q_DECL_OVERRIDE;
     quint8 mapper() const Q_DECL_OVERRIDE;
+    quint32 hooks() const Q_DECL_OVERRIDE;
 
     void hardReset() Q_DECL_OVERRIDE;
     void writePrg(quint16 address, quint8 value) Q_DECL_OVERRIDE;
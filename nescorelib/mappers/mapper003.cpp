@@ -10,6 +10,11 @@ quint8 Mapper003::mapper() const
     return 3;
 }
 
+quint32 Mapper003::hooks() const
+{
+    return HookNone;
+}
+
 void Mapper003::writePrg(quint16 address, quint8 value)
 {
     // Bus conflicts !!
@@ -2,7 +2,7 @@
 
 // local includes
 #include "nesemulator.h"
-#include "utils/datastreamutils.h"
+#include "snapshot.h"
 
 QString Mapper004::name() const
 {
@@ -14,6 +14,11 @@ quint8 Mapper004::mapper() const
     return 4;
 }
 
+quint32 Mapper004::hooks() const
+{
+    return HookPpuClock | HookPpuAddressUpdate;
+}
+
 void Mapper004::hardReset()
 {
     Board::hardReset();
@@ -119,22 +124,22 @@ void Mapper004::onPpuA12RaisingEdge()
     m_irqClear = false;
 }
 
-void Mapper004::readState(QDataStream &dataStream)
+void Mapper004::readState(SnapshotReader &snapshot)
 {
-    Board::readState(dataStream);
+    Board::readState(snapshot);
 
-    dataStream >> m_flagC >> m_flagP >> m_address8001 >> m_chrReg >> m_prgReg
+    snapshot >> m_flagC >> m_flagP >> m_address8001 >> m_chrReg >> m_prgReg
     // IRQ
     >> m_irqEnabled >> m_irqCounter >> m_oldIrqCounter >> m_irqReload >> m_irqClear >> m_mmc3AltBehavior;
 }
 
-void Mapper004::writeState(QDataStream &dataStream) const
+void Mapper004::writeState(SnapshotWriter &snapshot) const
 {
-    Board::writeState(dataStream);
+    Board::writeState(snapshot);
 
-    dataStream << m_flagC << m_flagP << m_address8001 << m_chrReg << m_prgReg
+    snapshot << m_flagC << m_flagP << m_address8001 << m_chrReg << m_prgReg
     // IRQ
-               << m_irqEnabled << m_irqCounter << m_oldIrqCounter << m_irqReload << m_irqClear << m_mmc3AltBehavior;
+             << m_irqEnabled << m_irqCounter << m_oldIrqCounter << m_irqReload << m_irqClear << m_mmc3AltBehavior;
 }
 
 bool Mapper004::ppuA12ToggleTimerEnabled() const
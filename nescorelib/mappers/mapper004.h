@@ -10,6 +10,7 @@ public:
 
     QString name() const Q_DECL_OVERRIDE;
     quint8 mapper() const Q_DECL_OVERRIDE;
+    quint32 hooks() const Q_DECL_OVERRIDE;
 
     void hardReset() Q_DECL_OVERRIDE;
 
@@ -17,8 +18,8 @@ public:
 
     void onPpuA12RaisingEdge() Q_DECL_OVERRIDE;
 
-    void readState(QDataStream &dataStream) Q_DECL_OVERRIDE;
-    void writeState(QDataStream &dataStream) const Q_DECL_OVERRIDE;
+    void readState(SnapshotReader &snapshot) Q_DECL_OVERRIDE;
+    void writeState(SnapshotWriter &snapshot) const Q_DECL_OVERRIDE;
 
 protected:
     bool ppuA12ToggleTimerEnabled() const Q_DECL_OVERRIDE;
@@ -0,0 +1,84 @@
+#include "movie.h"
+
+// Qt includes
+#include <QFile>
+#include <QDataStream>
+
+// system includes
+#include <stdexcept>
+
+// local includes
+#include "framecount.h"
+
+namespace {
+// header: magic, version, flags, reserved byte, rom crc and frame count
+constexpr quint32 movieMagic = 0x4D53454E; // "NESM"
+constexpr quint16 movieVersion = 1;
+constexpr quint8 flagFrameCrcs = 0x01;
+}
+
+void Movie::toFile(const QString &path) const
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+        throw std::runtime_error(QString("cannot open file %0 because %1").arg(file.fileName(), file.errorString()).toStdString());
+
+    QDataStream dataStream(&file);
+    dataStream.setByteOrder(QDataStream::LittleEndian);
+
+    dataStream << movieMagic << movieVersion << quint8(hasFrameCrcs ? flagFrameCrcs : 0) << quint8(0)
+               << romCrc << quint32(frames.size());
+
+    for(const auto &frame : frames)
+    {
+        dataStream << frame.events;
+        for(const auto input : frame.inputs)
+            dataStream << input;
+        if(hasFrameCrcs)
+            dataStream << frame.frameCrc;
+    }
+
+    if(dataStream.status() != QDataStream::Ok)
+        throw std::runtime_error(QString("cannot write file %0").arg(file.fileName()).toStdString());
+}
+
+Movie Movie::fromFile(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        throw std::runtime_error(QString("cannot open file %0 because %1").arg(file.fileName(), file.errorString()).toStdString());
+
+    QDataStream dataStream(&file);
+    dataStream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic;
+    quint16 version;
+    quint8 flags;
+    quint8 reserved;
+
+    Movie movie;
+    dataStream >> magic >> version >> flags >> reserved >> movie.romCrc;
+
+    if(dataStream.status() != QDataStream::Ok || magic != movieMagic)
+        throw std::runtime_error("wrong header");
+    if(version != movieVersion)
+        throw std::runtime_error("unsupported movie version");
+
+    movie.hasFrameCrcs = flags & flagFrameCrcs;
+
+    movie.frames.resize(readFrameCount(dataStream, movie.hasFrameCrcs ? 9 : 5));
+
+    for(auto &frame : movie.frames)
+    {
+        dataStream >> frame.events;
+        for(auto &input : frame.inputs)
+            dataStream >> input;
+        if(movie.hasFrameCrcs)
+            dataStream >> frame.frameCrc;
+    }
+
+    if(dataStream.status() != QDataStream::Ok)
+        throw std::runtime_error("movie is not long enough");
+
+    return movie;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+#include <QString>
+
+// system includes
+#include <array>
+#include <vector>
+
+// Input recording of a run starting at power on. Every frame stores the reset events to
+// apply before it, the 4 controller bytes latched during it and optionally the crc32 of
+// the resulting framebuffer, so a replay can be checked for bit exactness.
+struct NESCORELIB_EXPORT Movie
+{
+    enum Event : quint8 {
+        EventNone = 0x00,
+        EventSoftReset = 0x01,
+        EventHardReset = 0x02
+    };
+
+    struct Frame {
+        quint8 events {};
+        std::array<quint8, 4> inputs {};
+        quint32 frameCrc {};
+    };
+
+    quint32 romCrc {};
+    bool hasFrameCrcs {};
+    std::vector<Frame> frames;
+
+    void toFile(const QString &path) const;
+
+    static Movie fromFile(const QString &path);
+};
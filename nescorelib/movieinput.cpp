@@ -0,0 +1,21 @@
+#include "movieinput.h"
+
+// local includes
+#include "movie.h"
+
+MovieInput::MovieInput(const Movie &movie, int controller) :
+    m_movie(movie),
+    m_controller(controller)
+{
+}
+
+void MovieInput::update()
+{
+    m_data = m_nextFrame < m_movie.frames.size() ? m_movie.frames[m_nextFrame].inputs[m_controller] : 0;
+    m_nextFrame++;
+}
+
+quint8 MovieInput::getData() const
+{
+    return m_data;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "nescorelib_global.h"
+#include "inputprovider.h"
+
+// system includes
+#include <cstddef>
+
+// forward declarations
+struct Movie;
+
+// Replays the recorded bytes of one controller, advancing a frame with every update().
+// After the end of the movie no buttons are pressed.
+class NESCORELIB_EXPORT MovieInput : public InputProvider
+{
+public:
+    explicit MovieInput(const Movie &movie, int controller);
+
+    void update() Q_DECL_OVERRIDE;
+    quint8 getData() const Q_DECL_OVERRIDE;
+
+private:
+    const Movie &m_movie;
+    const int m_controller;
+    std::size_t m_nextFrame {};
+    quint8 m_data {};
+};
@@ -3,9 +3,18 @@
 // system includes
 #include <cmath>
 #include <algorithm>
+#include <stdexcept>
 
 // local includes
 #include "emusettings.h"
+#include "snapshot.h"
+
+namespace {
+// header: magic, version, mapper, reserved byte and payload size
+constexpr quint32 stateMagic = 0x5353454E; // "NESS"
+constexpr quint16 stateVersion = 3;
+constexpr std::size_t stateHeaderSize = 12;
+}
 
 NesEmulator::NesEmulator() :
     m_apu(*this),
@@ -16,26 +25,35 @@ NesEmulator::NesEmulator() :
     m_ports(*this),
     m_ppu(*this)
 {
-    QObject::connect(&m_ppu, &Ppu::frameFinished, this, &NesEmulator::frameFinished);
 }
 
 void NesEmulator::load(const Rom &rom)
 {
     m_memory.initialize(rom);
 
+    m_ppuCatchUp = m_ppuCatchUpEnabled && m_memory.board()->ppuCatchUpAllowed();
+
     hardReset();
 
     if(m_memory.board()->enableExternalSound())
         m_memory.board()->apuApplyChannelsSettings();
+
+    SnapshotWriter counter;
+    writeState(counter);
+    m_stateSize = stateHeaderSize + counter.size();
 }
 
 void NesEmulator::hardReset()
 {
+    ppuCatchUp();
+
     m_memory.hardReset();
     m_cpu.hardReset();
     m_ppu.hardReset();
     m_apu.hardReset();
     m_dma.hardReset();
+
+    m_ppuClockBudget = m_ppu.clocksUntilEvent();
 }
 
 void NesEmulator::softReset()
@@ -50,6 +68,8 @@ void NesEmulator::emuClockFrame()
     while(!m_frameFinished)
         m_cpu.clock();
 
+    ppuCatchUp();
+
     /*
     m_emuTimeFrame = QDateTime::currentMSecsSinceEpoch() - m_emuTimePrevious;
 
@@ -75,35 +95,177 @@ void NesEmulator::emuClockFrame()
 
 void NesEmulator::emuClockComponents()
 {
-    m_ppu.clock();
-    m_interrupts.pollStatus();
-    m_ppu.clock();
-    m_ppu.clock();
+    NESCORE_PROFILE_SCOPE(m_profiler, EmuClockComponents);
+
+    m_cycles++;
+
+    if(m_ppuCatchUp && !m_ppu.regAccessHappened() && m_ppuPendingClocks + 3 <= m_ppuClockBudget)
+    {
+        // Nothing can observe these ppu clocks before the next register access,
+        // bank switch or event, so they get run later in one go.
+        m_ppuPendingClocks += 3;
+        m_interrupts.pollStatus();
+    }
+    else
+    {
+        ppuCatchUp();
+
+        m_ppu.clock();
+        m_interrupts.pollStatus();
+        m_ppu.clock();
+        m_ppu.clock();
+
+        m_ppuClockBudget = m_ppu.clocksUntilEvent();
+    }
+
     m_apu.clock();
     m_dma.clock();
-    m_memory.board()->onCpuClock();
+    if(m_memory.boardHooked(Board::HookCpuClock))
+    {
+        NESCORE_PROFILE_SCOPE(m_profiler, BoardCpuClock);
+        m_memory.board()->onCpuClock();
+    }
 }
 
-void NesEmulator::writeState(QDataStream &dataStream) const
+void NesEmulator::ppuCatchUp()
 {
-    m_apu.writeState(dataStream);
-    m_cpu.writeState(dataStream);
-    m_dma.writeState(dataStream);
-    m_interrupts.writeState(dataStream);
-    m_memory.writeState(dataStream);
-    m_ports.portWriteState(dataStream);
-    m_ppu.writeState(dataStream);
+    if(!m_ppuPendingClocks)
+        return;
+
+    while(m_ppuPendingClocks > 0)
+    {
+        if(m_ppuPendingClocks >= 341 && m_ppu.scanlineFastPossible())
+        {
+            m_ppuPendingClocks -= 341;
+            m_ppu.scanlineRenderFast();
+        }
+        else
+        {
+            m_ppuPendingClocks--;
+            m_ppu.clock();
+        }
+    }
+
+    m_ppuClockBudget = m_ppu.clocksUntilEvent();
+}
+
+std::size_t NesEmulator::stateSize() const
+{
+    return m_stateSize;
 }
 
-void NesEmulator::readState(QDataStream &dataStream)
+void NesEmulator::saveState(quint8 *buffer, std::size_t size) const
 {
-    m_apu.readState(dataStream);
-    m_cpu.readState(dataStream);
-    m_dma.readState(dataStream);
-    m_interrupts.readState(dataStream);
-    m_memory.readState(dataStream);
-    m_ports.portReadState(dataStream);
-    m_ppu.readState(dataStream);
+    if(!m_stateSize)
+        throw std::runtime_error("no rom loaded");
+    if(size < m_stateSize)
+        throw std::runtime_error("savestate buffer is too small");
+
+    SnapshotWriter snapshot(buffer, size);
+    snapshot << stateMagic << stateVersion << m_memory.board()->mapper() << quint8(0) << quint32(m_stateSize - stateHeaderSize);
+    writeState(snapshot);
+
+    Q_ASSERT(snapshot.size() == m_stateSize);
+}
+
+void NesEmulator::loadState(const quint8 *buffer, std::size_t size)
+{
+    if(!m_stateSize)
+        throw std::runtime_error("no rom loaded");
+    if(size < m_stateSize)
+        throw std::runtime_error("savestate is truncated");
+
+    SnapshotReader snapshot(buffer, size);
+
+    quint32 magic;
+    quint16 version;
+    quint8 mapper;
+    quint8 reserved;
+    quint32 payloadSize;
+    snapshot >> magic >> version >> mapper >> reserved >> payloadSize;
+
+    if(magic != stateMagic)
+        throw std::runtime_error("not a savestate");
+    if(version != stateVersion)
+        throw std::runtime_error("unsupported savestate version");
+    if(mapper != m_memory.board()->mapper() || stateHeaderSize + payloadSize != m_stateSize)
+        throw std::runtime_error("savestate belongs to another rom");
+
+    readState(snapshot);
+
+    m_ppuClockBudget = m_ppu.clocksUntilEvent();
+}
+
+void NesEmulator::writeState(SnapshotWriter &snapshot) const
+{
+    m_apu.writeState(snapshot);
+    m_cpu.writeState(snapshot);
+    m_dma.writeState(snapshot);
+    m_interrupts.writeState(snapshot);
+    m_memory.writeState(snapshot);
+    m_ports.portWriteState(snapshot);
+    m_ppu.writeState(snapshot);
+
+    snapshot << m_ppuPendingClocks;
+}
+
+void NesEmulator::readState(SnapshotReader &snapshot)
+{
+    m_apu.readState(snapshot);
+    m_cpu.readState(snapshot);
+    m_dma.readState(snapshot);
+    m_interrupts.readState(snapshot);
+    m_memory.readState(snapshot);
+    m_ports.portReadState(snapshot);
+    m_ppu.readState(snapshot);
+
+    snapshot >> m_ppuPendingClocks;
+}
+
+quint64 NesEmulator::cycles() const
+{
+    return m_cycles;
+}
+
+NesEmulator::Statistics NesEmulator::statistics() const
+{
+    return Statistics { m_cycles, m_cpu.statistics(), m_ppu.statistics(), m_profiler.snapshot() };
+}
+
+void NesEmulator::setStatistics(const Statistics &statistics)
+{
+    m_cycles = statistics.cycles;
+    m_cpu.setStatistics(statistics.cpu);
+    m_ppu.setStatistics(statistics.ppu);
+    m_profiler.setSnapshot(statistics.profile);
+}
+
+ProfileSnapshot NesEmulator::profileSnapshot() const
+{
+    return m_profiler.snapshot();
+}
+
+void NesEmulator::resetProfile()
+{
+    m_profiler.reset();
+}
+
+Profiler &NesEmulator::profiler()
+{
+    return m_profiler;
+}
+
+bool NesEmulator::ppuCatchUpEnabled() const
+{
+    return m_ppuCatchUpEnabled;
+}
+
+void NesEmulator::setPpuCatchUpEnabled(bool ppuCatchUpEnabled)
+{
+    ppuCatchUp();
+
+    m_ppuCatchUpEnabled = ppuCatchUpEnabled;
+    m_ppuCatchUp = m_ppuCatchUpEnabled && m_memory.board() && m_memory.board()->ppuCatchUpAllowed();
 }
 
 Apu &NesEmulator::apu()
@@ -180,4 +342,40 @@ void NesEmulator::frameFinished()
 {
     m_apu.flush();
     m_frameFinished = true;
+
+    if(m_samplesCallbackEnabled && m_samplesFinishedCallback)
+        m_samplesFinishedCallback();
+
+    if(m_frameCallbackEnabled && m_frameFinishedCallback)
+        m_frameFinishedCallback(m_ppu.screenPixels());
+}
+
+void NesEmulator::setFrameFinishedCallback(const FrameFinishedCallback &frameFinishedCallback)
+{
+    m_frameFinishedCallback = frameFinishedCallback;
+}
+
+void NesEmulator::setSamplesFinishedCallback(const SamplesFinishedCallback &samplesFinishedCallback)
+{
+    m_samplesFinishedCallback = samplesFinishedCallback;
+}
+
+bool NesEmulator::frameCallbackEnabled() const
+{
+    return m_frameCallbackEnabled;
+}
+
+void NesEmulator::setFrameCallbackEnabled(bool frameCallbackEnabled)
+{
+    m_frameCallbackEnabled = frameCallbackEnabled;
+}
+
+bool NesEmulator::samplesCallbackEnabled() const
+{
+    return m_samplesCallbackEnabled;
+}
+
+void NesEmulator::setSamplesCallbackEnabled(bool samplesCallbackEnabled)
+{
+    m_samplesCallbackEnabled = samplesCallbackEnabled;
 }
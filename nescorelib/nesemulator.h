@@ -1,10 +1,14 @@
 #pragma once
 
 #include "nescorelib_global.h"
-#include <QObject>
+
+// Qt includes
+#include <QtGlobal>
 
 // system includes
 #include <array>
+#include <cstddef>
+#include <functional>
 #include <memory>
 
 // local includes
@@ -15,17 +19,33 @@
 #include "emu/memory.h"
 #include "emu/ports.h"
 #include "emu/ppu.h"
+#include "profiler.h"
 
 // forward declarations
-class QDataStream;
+class SnapshotReader;
+class SnapshotWriter;
 
 struct Rom;
 
-class NESCORELIB_EXPORT NesEmulator : public QObject
+class NESCORELIB_EXPORT NesEmulator
 {
-    Q_OBJECT
+    Q_DISABLE_COPY(NesEmulator)
 
 public:
+    // Both get called synchronously from inside the emulation at the end of every frame,
+    // first the samples one (read them with Apu::readSamples()), then the frame one.
+    using FrameFinishedCallback = std::function<void(const std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &frame)>;
+    using SamplesFinishedCallback = std::function<void()>;
+
+    // Everything counted for reports, none of it is part of the state. Emulation that gets
+    // taken back, like the hidden frames of run-ahead, puts them back as well.
+    struct Statistics {
+        quint64 cycles {};
+        Cpu::Statistics cpu;
+        Ppu::Statistics ppu;
+        ProfileSnapshot profile;
+    };
+
     explicit NesEmulator();
 
     void load(const Rom &rom);
@@ -35,9 +55,38 @@ public:
 
     void emuClockFrame();
     void emuClockComponents();
+    void ppuCatchUp();
+    void frameFinished();
+
+    void setFrameFinishedCallback(const FrameFinishedCallback &frameFinishedCallback);
+    void setSamplesFinishedCallback(const SamplesFinishedCallback &samplesFinishedCallback);
+
+    // Frames emulated while a callback is disabled are not presented through it
+    bool frameCallbackEnabled() const;
+    void setFrameCallbackEnabled(bool frameCallbackEnabled);
+    bool samplesCallbackEnabled() const;
+    void setSamplesCallbackEnabled(bool samplesCallbackEnabled);
+
+    // Savestates are a flat little endian blob with a fixed layout, so saving and loading
+    // is a series of memcpys into a buffer of stateSize() bytes. The size only depends on
+    // the loaded rom. Both throw std::runtime_error on a wrong buffer, saving also throws in
+    // the middle of a frame with audio enabled.
+    std::size_t stateSize() const;
+    void saveState(quint8 *buffer, std::size_t size) const;
+    void loadState(const quint8 *buffer, std::size_t size);
+
+    quint64 cycles() const;
+
+    Statistics statistics() const;
+    void setStatistics(const Statistics &statistics);
 
-    void writeState(QDataStream &dataStream) const;
-    void readState(QDataStream &dataStream);
+    // Hot path counters, only gathered in builds with NESCORE_PROFILE (see Profiler)
+    ProfileSnapshot profileSnapshot() const;
+    void resetProfile();
+    Profiler &profiler();
+
+    bool ppuCatchUpEnabled() const;
+    void setPpuCatchUpEnabled(bool ppuCatchUpEnabled);
 
     Apu &apu();
     const Apu &apu() const;
@@ -54,10 +103,10 @@ public:
     Ppu &ppu();
     const Ppu &ppu() const;
 
-private Q_SLOTS:
-    void frameFinished();
-
 private:
+    void writeState(SnapshotWriter &snapshot) const;
+    void readState(SnapshotReader &snapshot);
+
     Apu m_apu;
     Cpu m_cpu;
     Dma m_dma;
@@ -67,4 +116,20 @@ private:
     Ppu m_ppu;
 
     bool m_frameFinished;
+    FrameFinishedCallback m_frameFinishedCallback;
+    SamplesFinishedCallback m_samplesFinishedCallback;
+    bool m_frameCallbackEnabled { true };
+    bool m_samplesCallbackEnabled { true };
+
+    // ppu clocks are deferred while nothing can observe them
+    bool m_ppuCatchUpEnabled { true };
+    bool m_ppuCatchUp {}; // enabled and allowed by the board
+    qint32 m_ppuPendingClocks {};
+    qint32 m_ppuClockBudget {};
+
+    quint64 m_cycles {}; // emulated cpu cycles since construction
+
+    Profiler m_profiler;
+
+    std::size_t m_stateSize {}; // including the header
 };
@@ -0,0 +1,58 @@
+#include "profiler.h"
+
+const char *ProfileSnapshot::scopeName(Scope scope)
+{
+    switch(scope)
+    {
+    case CpuClock: return "Cpu::clock";
+    case EmuClockComponents: return "NesEmulator::emuClockComponents";
+    case PpuScanlineRender: return "Ppu::scanlineRender";
+    case PpuScanlineRenderFast: return "Ppu::scanlineRenderFast";
+    case PpuRenderPixel: return "Ppu::renderPixel";
+    case ApuUpdatePlayback: return "Apu::updatePlayback";
+    case DmaClock: return "Dma::clock";
+    case BoardCpuClock: return "Board::onCpuClock";
+    case BoardPpuClock: return "Board::onPpuClock";
+    case BoardPpuAddressUpdate: return "Board::onPpuAddressUpdate";
+    case BoardPpuScanlineTick: return "Board::onPpuScanlineTick";
+    case BoardExternalSound: return "Board external sound";
+    case ScopeCount: break;
+    }
+
+    return "unknown";
+}
+
+ProfileSnapshot ProfileSnapshot::operator-(const ProfileSnapshot &other) const
+{
+    ProfileSnapshot difference;
+    for(std::size_t i = 0; i < counters.size(); i++)
+    {
+        difference.counters[i].calls = counters[i].calls - other.counters[i].calls;
+        difference.counters[i].ticks = counters[i].ticks - other.counters[i].ticks;
+    }
+    return difference;
+}
+
+bool Profiler::compiledIn()
+{
+#ifdef NESCORE_PROFILE
+    return true;
+#else
+    return false;
+#endif
+}
+
+const ProfileSnapshot &Profiler::snapshot() const
+{
+    return m_snapshot;
+}
+
+void Profiler::setSnapshot(const ProfileSnapshot &snapshot)
+{
+    m_snapshot = snapshot;
+}
+
+void Profiler::reset()
+{
+    m_snapshot = ProfileSnapshot();
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <array>
+#include <chrono>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define NESCORE_PROFILE_RDTSC
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define NESCORE_PROFILE_RDTSC
+#endif
+
+// Call counts and accumulated ticks of the hot paths. The times are inclusive, CpuClock
+// contains everything that gets clocked by the bus accesses of the instruction. Ticks are
+// time stamp counter ticks on x86, nanoseconds elsewhere.
+struct NESCORELIB_EXPORT ProfileSnapshot
+{
+    enum Scope {
+        CpuClock,
+        EmuClockComponents,
+        PpuScanlineRender,
+        PpuScanlineRenderFast,
+        PpuRenderPixel,
+        ApuUpdatePlayback,
+        DmaClock,
+        BoardCpuClock, // Board::onCpuClock()
+        BoardPpuClock, // Board::onPpuClock()
+        BoardPpuAddressUpdate, // Board::onPpuAddressUpdate()
+        BoardPpuScanlineTick, // Board::onPpuScanlineTick()
+        BoardExternalSound, // Board::onApuClock*() and apuGetSample()
+        ScopeCount
+    };
+
+    struct Counter {
+        quint64 calls {};
+        quint64 ticks {};
+    };
+
+    std::array<Counter, ScopeCount> counters {};
+
+    static const char *scopeName(Scope scope);
+
+    // The counts in between two snapshots, e.g. of a single frame
+    ProfileSnapshot operator-(const ProfileSnapshot &other) const;
+};
+
+// Gets only fed in builds with NESCORE_PROFILE, the scopes compile to nothing otherwise and
+// all counters stay 0.
+class NESCORELIB_EXPORT Profiler
+{
+    Q_DISABLE_COPY(Profiler)
+
+public:
+    Profiler() = default;
+
+    static bool compiledIn();
+
+    static quint64 ticks()
+    {
+#ifdef NESCORE_PROFILE_RDTSC
+        return __rdtsc();
+#else
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    ProfileSnapshot::Counter &counter(ProfileSnapshot::Scope scope) { return m_snapshot.counters[scope]; }
+
+    const ProfileSnapshot &snapshot() const;
+    void setSnapshot(const ProfileSnapshot &snapshot);
+    void reset();
+
+private:
+    ProfileSnapshot m_snapshot;
+};
+
+class ProfileScope
+{
+    Q_DISABLE_COPY(ProfileScope)
+
+public:
+    explicit ProfileScope(ProfileSnapshot::Counter &counter) :
+        m_counter(counter), m_start(Profiler::ticks())
+    {
+    }
+
+    ~ProfileScope()
+    {
+        m_counter.calls++;
+        m_counter.ticks += Profiler::ticks() - m_start;
+    }
+
+private:
+    ProfileSnapshot::Counter &m_counter;
+    const quint64 m_start;
+};
+
+// Counts the rest of the enclosing block, e.g. NESCORE_PROFILE_SCOPE(m_emu.profiler(), CpuClock);
+#ifdef NESCORE_PROFILE
+#define NESCORE_PROFILE_SCOPE(profiler, scope) const ProfileScope profileScope((profiler).counter(ProfileSnapshot::scope))
+#else
+#define NESCORE_PROFILE_SCOPE(profiler, scope) static_cast<void>(0)
+#endif
@@ -0,0 +1,284 @@
+#include "rewindbuffer.h"
+
+// Qt includes
+#include <QElapsedTimer>
+
+// system includes
+#include <algorithm>
+#include <cstring>
+
+// local includes
+#include "nesemulator.h"
+
+namespace {
+std::size_t writeVarint(quint8 *out, std::size_t value)
+{
+    std::size_t length = 0;
+    while(value >= 0x80)
+    {
+        out[length++] = quint8(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = quint8(value);
+    return length;
+}
+
+std::size_t readVarint(const quint8 *in, std::size_t &position)
+{
+    std::size_t value = 0;
+    for(auto shift = 0; ; shift += 7)
+    {
+        const auto byte = in[position++];
+        value |= std::size_t(byte & 0x7F) << shift;
+        if(!(byte & 0x80))
+            return value;
+    }
+}
+
+bool equalWords(const quint8 *a, const quint8 *b)
+{
+    quint64 wordA, wordB;
+    std::memcpy(&wordA, a, sizeof(wordA));
+    std::memcpy(&wordB, b, sizeof(wordB));
+    return wordA == wordB;
+}
+}
+
+RewindBuffer::RewindBuffer(NesEmulator &emu, std::size_t memoryBudget, int interval) :
+    m_emu(emu),
+    m_interval(std::max(interval, 1)),
+    m_memoryBudget(memoryBudget)
+{
+}
+
+void RewindBuffer::clear()
+{
+    m_frames = 0;
+    m_newest.clear();
+    m_newestCaptured = false;
+    m_deltas.clear();
+    m_ringUsed = 0;
+}
+
+void RewindBuffer::frameFinished()
+{
+    if(++m_frames < m_interval)
+        return;
+
+    m_frames = 0;
+    capture();
+}
+
+void RewindBuffer::capture()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const auto size = m_emu.stateSize();
+    m_capture.resize(size);
+    m_emu.saveState(m_capture.data(), size);
+
+    if(m_newest.size() == size)
+    {
+        // worst case is a token of at most 6 bytes for every 5 state bytes
+        m_scratch.resize(size * 2 + 16);
+        m_lastDeltaSize = encodeDelta(m_newest.data(), m_capture.data(), size, m_scratch.data());
+        storeDelta(m_scratch.data(), m_lastDeltaSize);
+    }
+    else
+    {
+        // first snapshot or another rom, the old history cannot be restored from this one
+        m_deltas.clear();
+        m_ringUsed = 0;
+        m_lastDeltaSize = 0;
+    }
+
+    std::swap(m_newest, m_capture);
+    m_newestCaptured = true;
+    m_newestCycles = m_emu.cycles();
+
+    m_lastCaptureTime = timer.nsecsElapsed();
+}
+
+bool RewindBuffer::stepBack()
+{
+    if(m_newest.empty())
+        return false;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // cycles() is not part of the state, it only stays the same without emulation
+    if(m_newestCaptured && m_emu.cycles() == m_newestCycles)
+    {
+        if(m_deltas.empty())
+            return false;
+        dropNewest();
+    }
+
+    m_emu.loadState(m_newest.data(), m_newest.size());
+    dropNewest();
+
+    m_frames = 0;
+
+    m_lastStepBackTime = timer.nsecsElapsed();
+
+    return true;
+}
+
+std::size_t RewindBuffer::snapshotCount() const
+{
+    return m_newest.empty() ? 0 : m_deltas.size() + 1;
+}
+
+std::size_t RewindBuffer::memoryBudget() const
+{
+    return m_memoryBudget;
+}
+
+int RewindBuffer::interval() const
+{
+    return m_interval;
+}
+
+std::size_t RewindBuffer::memoryUsed() const
+{
+    return m_ring.capacity() + m_newest.capacity() + m_capture.capacity() + m_scratch.capacity();
+}
+
+std::size_t RewindBuffer::lastDeltaSize() const
+{
+    return m_lastDeltaSize;
+}
+
+qint64 RewindBuffer::lastCaptureTime() const
+{
+    return m_lastCaptureTime;
+}
+
+qint64 RewindBuffer::lastStepBackTime() const
+{
+    return m_lastStepBackTime;
+}
+
+// The delta is a list of tokens: the count of unchanged bytes and the count of changed
+// bytes as varints, followed by the changed bytes XORed. Applying it to either snapshot
+// yields the other one.
+std::size_t RewindBuffer::encodeDelta(const quint8 *older, const quint8 *newer, std::size_t size, quint8 *out) const
+{
+    std::size_t length = 0;
+    std::size_t i = 0;
+
+    while(i < size)
+    {
+        const auto unchangedStart = i;
+        while(i + 8 <= size && equalWords(older + i, newer + i))
+            i += 8;
+        while(i < size && older[i] == newer[i])
+            i++;
+
+        // unchanged bytes at the end need no token
+        if(i == size)
+            break;
+
+        // the changed run ends at the first 4 unchanged bytes, shorter gaps are cheaper inline
+        const auto changedStart = i;
+        while(i < size)
+        {
+            if(older[i] != newer[i])
+            {
+                i++;
+                continue;
+            }
+
+            auto gapEnd = i;
+            while(gapEnd < size && gapEnd - i < 4 && older[gapEnd] == newer[gapEnd])
+                gapEnd++;
+            if(gapEnd - i >= 4 || gapEnd == size)
+                break;
+
+            i = gapEnd;
+        }
+
+        length += writeVarint(out + length, changedStart - unchangedStart);
+        length += writeVarint(out + length, i - changedStart);
+        for(auto j = changedStart; j < i; j++)
+            out[length++] = older[j] ^ newer[j];
+    }
+
+    return length;
+}
+
+void RewindBuffer::applyDelta(const quint8 *delta, std::size_t deltaSize, quint8 *state, std::size_t size) const
+{
+    std::size_t position = 0;
+    std::size_t offset = 0;
+
+    while(position < deltaSize)
+    {
+        offset += readVarint(delta, position);
+        const auto changed = readVarint(delta, position);
+        Q_ASSERT(offset + changed <= size);
+        Q_UNUSED(size)
+
+        for(std::size_t i = 0; i < changed; i++)
+            state[offset + i] ^= delta[position + i];
+
+        position += changed;
+        offset += changed;
+    }
+}
+
+void RewindBuffer::storeDelta(const quint8 *delta, std::size_t size)
+{
+    if(size > m_memoryBudget)
+    {
+        // does not fit at all, everything older is unreachable without it
+        m_deltas.clear();
+        m_ringUsed = 0;
+        return;
+    }
+
+    auto offset = m_deltas.empty() ? 0 : m_deltas.back().offset + m_deltas.back().size;
+    if(offset + size > m_memoryBudget)
+    {
+        // wrap around, the deltas left in the tail are the oldest ones
+        while(!m_deltas.empty() && m_deltas.front().offset >= offset)
+        {
+            m_ringUsed -= m_deltas.front().size;
+            m_deltas.pop_front();
+        }
+        offset = 0;
+    }
+
+    // the oldest deltas follow the write position
+    while(!m_deltas.empty() && m_deltas.front().offset >= offset && m_deltas.front().offset < offset + size)
+    {
+        m_ringUsed -= m_deltas.front().size;
+        m_deltas.pop_front();
+    }
+
+    // grows geometrically, the deltas keep their offsets
+    if(offset + size > m_ring.size())
+        m_ring.resize(std::min(m_memoryBudget, std::max(offset + size, m_ring.size() * 2)));
+
+    std::memcpy(&m_ring[offset], delta, size);
+    m_deltas.push_back({ offset, size });
+    m_ringUsed += size;
+}
+
+void RewindBuffer::dropNewest()
+{
+    m_newestCaptured = false;
+
+    if(m_deltas.empty())
+    {
+        m_newest.clear();
+        return;
+    }
+
+    const auto delta = m_deltas.back();
+    applyDelta(&m_ring[delta.offset], delta.size, m_newest.data(), m_newest.size());
+    m_deltas.pop_back();
+    m_ringUsed -= delta.size;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// forward declarations
+class NesEmulator;
+
+// Keeps the recent history of an emulator for rewinding. The newest snapshot is kept as
+// is, every older one only as the XOR against its successor, run length encoded. Most of
+// the state (wram, board ram, nametables, oam) does not change between two frames, so a
+// delta usually is a few hundred bytes. The deltas live in a ring growing up to memoryBudget
+// bytes, the oldest ones get dropped when it is full. The newest snapshot and the buffers to
+// capture and encode the next one come on top, about 4 times the state size.
+class NESCORELIB_EXPORT RewindBuffer
+{
+    Q_DISABLE_COPY(RewindBuffer)
+
+public:
+    explicit RewindBuffer(NesEmulator &emu, std::size_t memoryBudget = 32*1024*1024, int interval = 1);
+
+    // Forgets the whole history, needed after loading another rom
+    void clear();
+
+    // Call after every NesEmulator::emuClockFrame() (not from the frame callback, the cpu is
+    // in the middle of an instruction there), captures a snapshot every interval frames.
+    void frameFinished();
+    void capture();
+
+    // Loads the newest snapshot and drops it from the history, false when there is none. A
+    // snapshot of the current state (captured with no emulation since) gets skipped, loading
+    // it would change nothing.
+    bool stepBack();
+
+    std::size_t snapshotCount() const;
+    std::size_t memoryBudget() const;
+    int interval() const;
+
+    // Bytes allocated for the ring and the snapshot buffers
+    std::size_t memoryUsed() const;
+
+    std::size_t lastDeltaSize() const;
+    qint64 lastCaptureTime() const; // ns
+    qint64 lastStepBackTime() const; // ns
+
+private:
+    struct Delta {
+        std::size_t offset;
+        std::size_t size;
+    };
+
+    std::size_t encodeDelta(const quint8 *older, const quint8 *newer, std::size_t size, quint8 *out) const;
+    void applyDelta(const quint8 *delta, std::size_t deltaSize, quint8 *state, std::size_t size) const;
+    void storeDelta(const quint8 *delta, std::size_t size);
+    void dropNewest();
+
+    NesEmulator &m_emu;
+    const int m_interval;
+    int m_frames {};
+
+    std::vector<quint8> m_newest; // empty when there is no snapshot
+    bool m_newestCaptured {}; // by the last capture(), not uncovered by a step back
+    quint64 m_newestCycles {}; // emulator cycles at that capture
+    std::vector<quint8> m_capture;
+    std::vector<quint8> m_scratch;
+
+    const std::size_t m_memoryBudget;
+    std::vector<quint8> m_ring; // grows up to m_memoryBudget
+    std::deque<Delta> m_deltas; // oldest first
+    std::size_t m_ringUsed {};
+
+    std::size_t m_lastDeltaSize {};
+    qint64 m_lastCaptureTime {};
+    qint64 m_lastStepBackTime {};
+};
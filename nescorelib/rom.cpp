@@ -8,6 +8,23 @@
 #include <stdexcept>
 #include <array>
 
+// local includes
+#include "crc32.h"
+
+quint32 Rom::crc32() const
+{
+    quint32 crc = 0;
+
+    if(hasTrainer)
+        crc = ::crc32(trainer.data(), trainer.size(), crc);
+    for(const auto &page : prg)
+        crc = ::crc32(page.data(), page.size(), crc);
+    for(const auto &page : chr)
+        crc = ::crc32(page.data(), page.size(), crc);
+
+    return crc;
+}
+
 Rom Rom::fromFile(const QString &path)
 {
     QFile file(path);
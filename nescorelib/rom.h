@@ -28,5 +28,8 @@ struct NESCORELIB_EXPORT Rom
     QVector<std::array<quint8, 0x400> > chr;
     std::array<quint8, 512> trainer;
 
+    // Over the trainer, prg and chr data, identifies the rom e.g. for movies
+    quint32 crc32() const;
+
     static Rom fromFile(const QString &path);
 };
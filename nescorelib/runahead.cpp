@@ -0,0 +1,99 @@
+#include "runahead.h"
+
+// Qt includes
+#include <QElapsedTimer>
+
+// system includes
+#include <algorithm>
+
+// local includes
+#include "nesemulator.h"
+
+RunAhead::RunAhead(NesEmulator &emu, int frames) :
+    m_emu(emu),
+    m_frames(std::max(frames, 0)),
+    m_realFrame(std::make_unique<std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT>>())
+{
+}
+
+int RunAhead::frames() const
+{
+    return m_frames;
+}
+
+void RunAhead::setFrames(int frames)
+{
+    m_frames = std::max(frames, 0);
+}
+
+void RunAhead::emuClockFrame()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // the hidden frames drew over what the last real frame drew past its end
+    if(m_restoreRealFrame)
+    {
+        m_emu.ppu().setScreenPixels(*m_realFrame);
+        m_restoreRealFrame = false;
+    }
+
+    if(!m_frames)
+    {
+        m_emu.emuClockFrame();
+        if(m_realFrameCallback)
+            m_realFrameCallback(m_emu.ppu().screenPixels());
+        m_lastFrameTime = timer.nsecsElapsed();
+        m_lastOverheadTime = 0;
+        return;
+    }
+
+    // the real frame, only its audio
+    m_emu.setFrameCallbackEnabled(false);
+    m_emu.emuClockFrame();
+
+    // the framebuffer is not part of the state, it only holds the real frame until here
+    if(m_realFrameCallback)
+        m_realFrameCallback(m_emu.ppu().screenPixels());
+
+    const auto realFrameTime = timer.nsecsElapsed();
+
+    m_state.resize(m_emu.stateSize());
+    m_emu.saveState(m_state.data(), m_state.size());
+    *m_realFrame = m_emu.ppu().screenPixels();
+    m_restoreRealFrame = true;
+    const auto statistics = m_emu.statistics();
+
+    // frames ahead, only the video of the last one, their audio would get thrown away
+    const auto audioEnabled = m_emu.apu().audioEnabled();
+    m_emu.apu().setAudioEnabled(false);
+    m_emu.setSamplesCallbackEnabled(false);
+    for(auto i = 1; i < m_frames; i++)
+        m_emu.emuClockFrame();
+    m_emu.setFrameCallbackEnabled(true);
+    m_emu.emuClockFrame();
+    m_emu.setSamplesCallbackEnabled(true);
+    m_emu.apu().setAudioEnabled(audioEnabled);
+
+    // the counters are not part of the state
+    m_emu.loadState(m_state.data(), m_state.size());
+    m_emu.setStatistics(statistics);
+
+    m_lastFrameTime = timer.nsecsElapsed();
+    m_lastOverheadTime = m_lastFrameTime - realFrameTime;
+}
+
+void RunAhead::setRealFrameCallback(const NesEmulator::FrameFinishedCallback &realFrameCallback)
+{
+    m_realFrameCallback = realFrameCallback;
+}
+
+qint64 RunAhead::lastOverheadTime() const
+{
+    return m_lastOverheadTime;
+}
+
+qint64 RunAhead::lastFrameTime() const
+{
+    return m_lastFrameTime;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <memory>
+#include <vector>
+
+// local includes
+#include "nesemulator.h"
+
+// Hides the input latency games have by design: every frame is emulated for real (only its
+// audio gets presented), then frames() more frames are emulated with the same input and the
+// last one gets presented, before going back to the state after the real frame. The hidden
+// frames leave the statistics of the emulator (cycles, instructions, ...) untouched.
+class NESCORELIB_EXPORT RunAhead
+{
+    Q_DISABLE_COPY(RunAhead)
+
+public:
+    explicit RunAhead(NesEmulator &emu, int frames = 1);
+
+    int frames() const;
+    void setFrames(int frames);
+
+    // Replaces NesEmulator::emuClockFrame(), with 0 frames it is just that
+    void emuClockFrame();
+
+    // Gets the picture of the real frame, which is not the presented one when running ahead
+    void setRealFrameCallback(const NesEmulator::FrameFinishedCallback &realFrameCallback);
+
+    // Time spent on top of the real frame: the snapshot, the hidden frames and the restore
+    qint64 lastOverheadTime() const; // ns
+    qint64 lastFrameTime() const; // ns
+
+private:
+    NesEmulator &m_emu;
+    int m_frames;
+
+    std::vector<quint8> m_state;
+    NesEmulator::FrameFinishedCallback m_realFrameCallback;
+
+    // the picture after the real frame, the next real frame builds on it
+    std::unique_ptr<std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT>> m_realFrame;
+    bool m_restoreRealFrame {};
+
+    qint64 m_lastOverheadTime {};
+    qint64 m_lastFrameTime {};
+};
@@ -0,0 +1,156 @@
+#pragma once
+
+#include "nescorelib_global.h"
+
+// Qt includes
+#include <QtGlobal>
+#include <QtEndian>
+
+// system includes
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+// Streams the emulator state into a flat little endian buffer. Every value is stored with
+// its own fixed size (bools as one byte, doubles as their bit pattern, enums as their
+// underlying type), so the layout only depends on the order of the fields. Without a buffer
+// it only counts the bytes, which is used to find out the snapshot size once per rom.
+class SnapshotWriter
+{
+    Q_DISABLE_COPY(SnapshotWriter)
+
+public:
+    explicit SnapshotWriter(quint8 *data = nullptr, std::size_t capacity = 0) :
+        m_data(data), m_capacity(capacity)
+    {}
+
+    template<typename T>
+    SnapshotWriter &operator<<(const T &value)
+    {
+        if constexpr(std::is_same_v<T, bool>)
+            put(quint8(value ? 1 : 0));
+        else if constexpr(std::is_enum_v<T>)
+            put(static_cast<std::underlying_type_t<T>>(value));
+        else if constexpr(std::is_floating_point_v<T>)
+        {
+            static_assert(sizeof(T) == sizeof(quint64));
+            quint64 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            put(bits);
+        }
+        else
+        {
+            static_assert(std::is_integral_v<T>, "unsupported snapshot type");
+            put(value);
+        }
+
+        return *this;
+    }
+
+    template<typename T, std::size_t N>
+    SnapshotWriter &operator<<(const std::array<T, N> &values)
+    {
+        if constexpr(std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 1 || Q_BYTE_ORDER == Q_LITTLE_ENDIAN))
+            writeRaw(values.data(), sizeof(values));
+        else
+            for(const auto &value : values)
+                *this << value;
+
+        return *this;
+    }
+
+    void writeRaw(const void *data, std::size_t size)
+    {
+        if(m_data)
+        {
+            Q_ASSERT(m_size + size <= m_capacity);
+            std::memcpy(m_data + m_size, data, size);
+        }
+        m_size += size;
+    }
+
+    std::size_t size() const { return m_size; }
+
+private:
+    template<typename T>
+    void put(T value)
+    {
+        value = qToLittleEndian(value);
+        writeRaw(&value, sizeof(value));
+    }
+
+    quint8 *m_data;
+    std::size_t m_capacity;
+    std::size_t m_size {};
+};
+
+// Counterpart of SnapshotWriter, reading the values back in the same order.
+class SnapshotReader
+{
+    Q_DISABLE_COPY(SnapshotReader)
+
+public:
+    explicit SnapshotReader(const quint8 *data, std::size_t size) :
+        m_data(data), m_size(size)
+    {}
+
+    template<typename T>
+    SnapshotReader &operator>>(T &value)
+    {
+        if constexpr(std::is_same_v<T, bool>)
+            value = take<quint8>() != 0;
+        else if constexpr(std::is_enum_v<T>)
+            value = static_cast<T>(take<std::underlying_type_t<T>>());
+        else if constexpr(std::is_floating_point_v<T>)
+        {
+            static_assert(sizeof(T) == sizeof(quint64));
+            const auto bits = take<quint64>();
+            std::memcpy(&value, &bits, sizeof(value));
+        }
+        else
+        {
+            static_assert(std::is_integral_v<T>, "unsupported snapshot type");
+            value = take<T>();
+        }
+
+        return *this;
+    }
+
+    template<typename T, std::size_t N>
+    SnapshotReader &operator>>(std::array<T, N> &values)
+    {
+        if constexpr(std::is_integral_v<T> && !std::is_same_v<T, bool> && (sizeof(T) == 1 || Q_BYTE_ORDER == Q_LITTLE_ENDIAN))
+            readRaw(values.data(), sizeof(values));
+        else
+            for(auto &value : values)
+                *this >> value;
+
+        return *this;
+    }
+
+    void readRaw(void *data, std::size_t size)
+    {
+        if(m_position + size > m_size)
+            throw std::runtime_error("snapshot is truncated");
+
+        std::memcpy(data, m_data + m_position, size);
+        m_position += size;
+    }
+
+    std::size_t position() const { return m_position; }
+
+private:
+    template<typename T>
+    T take()
+    {
+        T value;
+        readRaw(&value, sizeof(value));
+        return qFromLittleEndian(value);
+    }
+
+    const quint8 *m_data;
+    std::size_t m_size;
+    std::size_t m_position {};
+};
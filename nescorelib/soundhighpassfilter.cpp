@@ -1,11 +1,29 @@
 #include "soundhighpassfilter.h"
 
-SoundHighPassFilter::SoundHighPassFilter(const double k) :
-    m_k(k)
+// system includes
+#include <cmath>
+
+// local includes
+#include "snapshot.h"
+
+SoundHighPassFilter::SoundHighPassFilter(const double cutoff) :
+    m_cutoff(cutoff)
 {
     reset();
 }
 
+double SoundHighPassFilter::cutoff() const
+{
+    return m_cutoff;
+}
+
+void SoundHighPassFilter::setSampleRate(const double sampleRate)
+{
+    // rc / (rc + dt)
+    const auto rc = 1. / (2. * M_PI * m_cutoff);
+    m_k = rc / (rc + 1. / sampleRate);
+}
+
 void SoundHighPassFilter::reset()
 {
     m_x = 0.;
@@ -19,3 +37,13 @@ double SoundHighPassFilter::doFiltering(const double sample)
     m_y = filtered;
     return filtered;
 }
+
+void SoundHighPassFilter::writeState(SnapshotWriter &snapshot) const
+{
+    snapshot << m_x << m_y;
+}
+
+void SoundHighPassFilter::readState(SnapshotReader &snapshot)
+{
+    snapshot >> m_x >> m_y;
+}
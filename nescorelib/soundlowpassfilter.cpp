@@ -1,11 +1,29 @@
 #include "soundlowpassfilter.h"
 
-SoundLowPassFilter::SoundLowPassFilter(const double k) :
-    m_k(k)
+// system includes
+#include <cmath>
+
+// local includes
+#include "snapshot.h"
+
+SoundLowPassFilter::SoundLowPassFilter(const double cutoff) :
+    m_cutoff(cutoff)
 {
     reset();
 }
 
+double SoundLowPassFilter::cutoff() const
+{
+    return m_cutoff;
+}
+
+void SoundLowPassFilter::setSampleRate(const double sampleRate)
+{
+    // dt / (rc + dt)
+    const auto rc = 1. / (2. * M_PI * m_cutoff);
+    m_k = (1. / sampleRate) / (rc + 1. / sampleRate);
+}
+
 void SoundLowPassFilter::reset()
 {
     m_x = 0.;
@@ -14,8 +32,18 @@ void SoundLowPassFilter::reset()
 
 double SoundLowPassFilter::doFiltering(const double sample)
 {
-    const auto filtered = (sample - m_y) * m_k;
+    const auto filtered = m_y + (sample - m_y) * m_k;
     m_x = sample;
     m_y = filtered;
     return filtered;
 }
+
+void SoundLowPassFilter::writeState(SnapshotWriter &snapshot) const
+{
+    snapshot << m_x << m_y;
+}
+
+void SoundLowPassFilter::readState(SnapshotReader &snapshot)
+{
+    snapshot >> m_x >> m_y;
+}
@@ -2,16 +2,28 @@
 
 #include "nescorelib_global.h"
 
+// forward declarations
+class SnapshotReader;
+class SnapshotWriter;
+
+// First order low pass, the coefficient follows from the cutoff and the output sample rate
 class NESCORELIB_EXPORT SoundLowPassFilter
 {
 public:
-    SoundLowPassFilter(const double k);
+    explicit SoundLowPassFilter(const double cutoff);
+
+    double cutoff() const;
+    void setSampleRate(const double sampleRate);
 
     void reset();
     double doFiltering(const double sample);
 
+    void writeState(SnapshotWriter &snapshot) const;
+    void readState(SnapshotReader &snapshot);
+
 private:
-    const double m_k;
+    const double m_cutoff;
+    double m_k {};
     double m_y;
     double m_x;
 };
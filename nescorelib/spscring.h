@@ -0,0 +1,106 @@
+#pragma once
+
+// Qt includes
+#include <QtGlobal>
+
+// system includes
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Bounded lock free queue between exactly one producer and one consumer thread. The slots
+// get allocated once, the producer fills the slot returned by writeSlot() in place and
+// publishes it with push(), the consumer handles readSlot() and hands it back with pop().
+// For plain values like audio samples write() and read() copy whole blocks at once.
+template<typename T>
+class SpscRing
+{
+    Q_DISABLE_COPY(SpscRing)
+
+public:
+    // every slot starts as a copy of value, which lets slots own preallocated buffers
+    explicit SpscRing(std::size_t capacity, const T &value = T()) :
+        m_slots(capacity + 1, value) // one slot stays empty to tell full from empty
+    {
+    }
+
+    std::size_t capacity() const { return m_slots.size() - 1; }
+
+    // Filled slots, from either side only a snapshot
+    std::size_t size() const
+    {
+        const auto head = m_head.load(std::memory_order_acquire);
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + m_slots.size() - head;
+    }
+
+    // Producer side, nullptr when the ring is full
+    T *writeSlot()
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        if(next(tail) == m_head.load(std::memory_order_acquire))
+            return nullptr;
+        return &m_slots[tail];
+    }
+
+    void push()
+    {
+        m_tail.store(next(m_tail.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    // Producer side, copies as many values as fit and returns their count
+    std::size_t write(const T *values, std::size_t count)
+    {
+        const auto tail = m_tail.load(std::memory_order_relaxed);
+        const auto head = m_head.load(std::memory_order_acquire);
+        const auto free = (head > tail ? head - tail : head + m_slots.size() - tail) - 1;
+        count = std::min(count, free);
+
+        const auto first = std::min(count, m_slots.size() - tail);
+        std::copy_n(values, first, m_slots.begin() + tail);
+        std::copy_n(values + first, count - first, m_slots.begin());
+
+        m_tail.store((tail + count) % m_slots.size(), std::memory_order_release);
+        return count;
+    }
+
+    // Consumer side, nullptr when the ring is empty
+    T *readSlot()
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        if(head == m_tail.load(std::memory_order_acquire))
+            return nullptr;
+        return &m_slots[head];
+    }
+
+    void pop()
+    {
+        m_head.store(next(m_head.load(std::memory_order_relaxed)), std::memory_order_release);
+    }
+
+    // Consumer side, copies as many values as available and returns their count
+    std::size_t read(T *values, std::size_t count)
+    {
+        const auto head = m_head.load(std::memory_order_relaxed);
+        const auto tail = m_tail.load(std::memory_order_acquire);
+        const auto available = tail >= head ? tail - head : tail + m_slots.size() - head;
+        count = std::min(count, available);
+
+        const auto first = std::min(count, m_slots.size() - head);
+        std::copy_n(m_slots.cbegin() + head, first, values);
+        std::copy_n(m_slots.cbegin(), count - first, values + first);
+
+        m_head.store((head + count) % m_slots.size(), std::memory_order_release);
+        return count;
+    }
+
+private:
+    std::size_t next(std::size_t index) const { return index + 1 == m_slots.size() ? 0 : index + 1; }
+
+    std::vector<T> m_slots;
+
+    // on separate cache lines, each one is written by one side only
+    alignas(64) std::atomic<std::size_t> m_head {};
+    alignas(64) std::atomic<std::size_t> m_tail {};
+};
@@ -0,0 +1,268 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QVector>
+
+// system includes
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// nescorelib includes
+#include "nesemulator.h"
+#include "rom.h"
+#include "movie.h"
+#include "movieinput.h"
+#include "crc32.h"
+#include "framecount.h"
+
+// Runs every rom of a corpus directory headlessly and compares the crc32 of every frame's
+// framebuffer and audio samples against golden files next to the roms. A rom foo.nes is
+// driven by the movie foo.nesm when there is one, the checksums live in foo.golden.
+
+namespace {
+// golden file header: magic, version and frame count
+constexpr quint32 goldenMagic = 0x4753454E; // "NESG"
+constexpr quint16 goldenVersion = 1;
+
+struct FrameCrcs {
+    quint32 video;
+    quint32 audio;
+};
+
+struct Result {
+    QString rom;
+    quint64 frames {};
+    qint64 nsecs {}; // emulation only, without hashing
+    QString status;
+    bool failed {};
+};
+
+std::vector<FrameCrcs> readGolden(const QString &path)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::ReadOnly))
+        throw std::runtime_error(QString("cannot open file %0 because %1").arg(file.fileName(), file.errorString()).toStdString());
+
+    QDataStream dataStream(&file);
+    dataStream.setByteOrder(QDataStream::LittleEndian);
+
+    quint32 magic;
+    quint16 version;
+    dataStream >> magic >> version;
+    if(dataStream.status() != QDataStream::Ok || magic != goldenMagic || version != goldenVersion)
+        throw std::runtime_error("wrong header");
+
+    // a video and an audio crc per frame
+    std::vector<FrameCrcs> frames(readFrameCount(dataStream, 8));
+    for(auto &frame : frames)
+        dataStream >> frame.video >> frame.audio;
+
+    if(dataStream.status() != QDataStream::Ok)
+        throw std::runtime_error("golden file is not long enough");
+
+    return frames;
+}
+
+void writeGolden(const QString &path, const std::vector<FrameCrcs> &frames)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+        throw std::runtime_error(QString("cannot open file %0 because %1").arg(file.fileName(), file.errorString()).toStdString());
+
+    QDataStream dataStream(&file);
+    dataStream.setByteOrder(QDataStream::LittleEndian);
+
+    dataStream << goldenMagic << goldenVersion << quint32(frames.size());
+    for(const auto &frame : frames)
+        dataStream << frame.video << frame.audio;
+
+    // a full disk may only show when the buffered rest gets written
+    if(dataStream.status() != QDataStream::Ok || !file.flush())
+        throw std::runtime_error(QString("cannot write file %0").arg(file.fileName()).toStdString());
+}
+
+Result runRom(const QFileInfo &romInfo, quint64 defaultFrames, bool update)
+{
+    Result result;
+    result.rom = romInfo.fileName();
+
+    const auto basePath = romInfo.dir().filePath(romInfo.completeBaseName());
+    const auto moviePath = basePath + QStringLiteral(".nesm");
+    const auto goldenPath = basePath + QStringLiteral(".golden");
+
+    NesEmulator emulator;
+    const auto rom = Rom::fromFile(romInfo.filePath());
+    emulator.load(rom);
+
+    Movie movie;
+    auto frames = defaultFrames;
+    if(QFile::exists(moviePath))
+    {
+        movie = Movie::fromFile(moviePath);
+        if(movie.romCrc != rom.crc32())
+            throw std::runtime_error("movie was recorded with another rom");
+
+        for(auto i = 0; i < 4; i++)
+            emulator.ports().setInput(i, std::make_unique<MovieInput>(movie, i));
+
+        frames = movie.frames.size();
+    }
+
+    // only collected here, the hashing happens outside of the timed part
+    QVector<qint32> samples;
+    emulator.setSamplesFinishedCallback([&emulator, &samples](){
+        samples.resize(emulator.apu().samplesAvailable());
+        emulator.apu().readSamples(samples.data(), samples.size());
+    });
+
+    std::vector<FrameCrcs> crcs;
+    crcs.reserve(frames);
+
+    QElapsedTimer timer;
+    for(quint64 i = 0; i < frames; i++)
+    {
+        const auto events = i < movie.frames.size() ? movie.frames[i].events : quint8(Movie::EventNone);
+
+        timer.start();
+
+        if(events & Movie::EventHardReset)
+            emulator.hardReset();
+        if(events & Movie::EventSoftReset)
+            emulator.softReset();
+
+        emulator.ports().update();
+        emulator.emuClockFrame();
+
+        result.nsecs += timer.nsecsElapsed();
+
+        const auto &screen = emulator.ppu().screenPixels();
+        crcs.push_back({ crc32(screen.data(), screen.size() * sizeof(qint32)),
+                         crc32(samples.constData(), samples.size() * sizeof(qint32)) });
+    }
+
+    result.frames = frames;
+
+    if(update)
+    {
+        writeGolden(goldenPath, crcs);
+        result.status = QStringLiteral("updated");
+        return result;
+    }
+
+    if(!QFile::exists(goldenPath))
+    {
+        result.status = QStringLiteral("no golden file");
+        result.failed = true;
+        return result;
+    }
+
+    const auto golden = readGolden(goldenPath);
+    if(golden.size() != crcs.size())
+    {
+        result.status = QStringLiteral("golden file has %0 frames").arg(golden.size());
+        result.failed = true;
+        return result;
+    }
+
+    for(std::size_t i = 0; i < crcs.size(); i++)
+    {
+        if(crcs[i].video != golden[i].video)
+        {
+            result.status = QStringLiteral("video differs from frame %0").arg(i);
+            result.failed = true;
+            return result;
+        }
+        if(crcs[i].audio != golden[i].audio)
+        {
+            result.status = QStringLiteral("audio differs from frame %0").arg(i);
+            result.failed = true;
+            return result;
+        }
+    }
+
+    result.status = QStringLiteral("ok");
+    return result;
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("nescore_regress"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Compares the framebuffer and audio of every rom in a corpus against golden checksums."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("corpus"), QStringLiteral("Directory with the roms (*.nes), movies (*.nesm) and golden files (*.golden)."));
+
+    const QCommandLineOption framesOption(QStringList { QStringLiteral("f"), QStringLiteral("frames") },
+                                          QStringLiteral("Number of frames to emulate for roms without movie (default 600)."),
+                                          QStringLiteral("count"), QStringLiteral("600"));
+    const QCommandLineOption updateOption(QStringLiteral("update"),
+                                          QStringLiteral("Write the golden files from this run instead of comparing."));
+    parser.addOption(framesOption);
+    parser.addOption(updateOption);
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if(parser.positionalArguments().count() != 1)
+    {
+        err << "exactly one corpus directory expected" << endl;
+        return 1;
+    }
+
+    bool ok;
+    const auto frames = parser.value(framesOption).toULongLong(&ok);
+    if(!ok)
+    {
+        err << "invalid frame count " << parser.value(framesOption) << endl;
+        return 1;
+    }
+
+    const QDir corpus(parser.positionalArguments().first());
+    const auto roms = corpus.entryList(QStringList { QStringLiteral("*.nes") }, QDir::Files, QDir::Name);
+    if(roms.isEmpty())
+    {
+        err << "no roms in " << corpus.path() << endl;
+        return 1;
+    }
+
+    auto failures = 0;
+
+    out << QStringLiteral("rom").leftJustified(32) << QStringLiteral("frames").rightJustified(8)
+        << QStringLiteral("seconds").rightJustified(10) << QStringLiteral("fps").rightJustified(10) << "  result" << endl;
+
+    for(const auto &name : roms)
+    {
+        Result result;
+        try {
+            result = runRom(QFileInfo(corpus, name), frames, parser.isSet(updateOption));
+        } catch (const std::exception &e) {
+            result.rom = name;
+            result.status = QString::fromStdString(e.what());
+            result.failed = true;
+        }
+
+        if(result.failed)
+            failures++;
+
+        const auto seconds = result.nsecs / 1000000000.;
+        out << result.rom.leftJustified(32) << QString::number(result.frames).rightJustified(8)
+            << QString::number(seconds, 'f', 3).rightJustified(10)
+            << QString::number(seconds > 0 ? result.frames / seconds : 0., 'f', 1).rightJustified(10)
+            << "  " << result.status << endl;
+    }
+
+    out << (roms.count() - failures) << "/" << roms.count() << " roms passed" << endl;
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,97 @@
+#include "audioringdevice.h"
+
+// system includes
+#include <algorithm>
+#include <cstring>
+
+AudioRingDevice::AudioRingDevice(std::size_t capacity, std::size_t targetFill, QObject *parent) :
+    QIODevice(parent),
+    m_ring(capacity),
+    m_targetFill(std::min(std::max<std::size_t>(targetFill, 1), capacity)),
+    m_readBuffer(capacity),
+    m_averageFill(m_targetFill)
+{
+}
+
+void AudioRingDevice::pushSamples(const qint32 *samples, std::size_t count)
+{
+    m_overflows += count - m_ring.write(samples, count);
+}
+
+double AudioRingDevice::updateRateAdjustment()
+{
+    // the device pulls in chunks, only the average fill tells the drift between both clocks
+    m_averageFill += (double(m_ring.size()) - m_averageFill) * fillSmoothing;
+
+    // proportional, the full adjustment when the ring is half empty or half again as full
+    const auto error = (m_targetFill - m_averageFill) / m_targetFill;
+    m_rateAdjustment = 1. + std::clamp(error * 2. * maxRateAdjustment, -maxRateAdjustment, maxRateAdjustment);
+
+    return m_rateAdjustment;
+}
+
+std::size_t AudioRingDevice::capacity() const
+{
+    return m_ring.capacity();
+}
+
+std::size_t AudioRingDevice::targetFill() const
+{
+    return m_targetFill;
+}
+
+std::size_t AudioRingDevice::fill() const
+{
+    return m_ring.size();
+}
+
+double AudioRingDevice::averageFill() const
+{
+    return m_averageFill;
+}
+
+double AudioRingDevice::rateAdjustment() const
+{
+    return m_rateAdjustment;
+}
+
+quint64 AudioRingDevice::underruns() const
+{
+    return m_underruns;
+}
+
+quint64 AudioRingDevice::overflows() const
+{
+    return m_overflows;
+}
+
+bool AudioRingDevice::isSequential() const
+{
+    return true;
+}
+
+qint64 AudioRingDevice::bytesAvailable() const
+{
+    return m_ring.size() * sizeof(qint32) + QIODevice::bytesAvailable();
+}
+
+qint64 AudioRingDevice::readData(char *data, qint64 maxlen)
+{
+    // the buffer of the audio output is not necessarily aligned for qint32
+    const auto count = std::min(std::size_t(maxlen) / sizeof(qint32), m_readBuffer.size());
+    const auto read = m_ring.read(m_readBuffer.data(), count);
+    std::fill(m_readBuffer.begin() + read, m_readBuffer.begin() + count, 0);
+    m_underruns += count - read;
+
+    std::memcpy(data, m_readBuffer.data(), count * sizeof(qint32));
+    return count * sizeof(qint32);
+}
+
+qint64 AudioRingDevice::writeData(const char *data, qint64 len)
+{
+    Q_UNUSED(data)
+    Q_UNUSED(len)
+
+    // samples only come in through pushSamples()
+    return -1;
+}
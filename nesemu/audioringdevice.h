@@ -0,0 +1,61 @@
+#pragma once
+
+// Qt includes
+#include <QIODevice>
+
+// system includes
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// nescorelib includes
+#include "spscring.h"
+
+// Sequential device QAudioOutput pulls the samples from. The emulation thread pushes into a
+// fixed size lock free ring, the audio thread reads from it and plays silence when it runs
+// dry. updateRateAdjustment() tells once per frame how much faster or slower the apu should
+// generate samples to keep the ring at the target fill.
+class AudioRingDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit AudioRingDevice(std::size_t capacity, std::size_t targetFill, QObject *parent = nullptr);
+
+    // emulation thread, samples that do not fit anymore get dropped
+    void pushSamples(const qint32 *samples, std::size_t count);
+    double updateRateAdjustment();
+
+    std::size_t capacity() const;
+    std::size_t targetFill() const;
+    std::size_t fill() const;
+    double averageFill() const; // smoothed over the last frames
+    double rateAdjustment() const;
+    quint64 underruns() const; // samples played as silence
+    quint64 overflows() const; // samples dropped
+
+    bool isSequential() const Q_DECL_OVERRIDE;
+    qint64 bytesAvailable() const Q_DECL_OVERRIDE;
+
+protected:
+    qint64 readData(char *data, qint64 maxlen) Q_DECL_OVERRIDE;
+    qint64 writeData(const char *data, qint64 len) Q_DECL_OVERRIDE;
+
+private:
+    // the rate never gets adjusted by more than 0.5%, that is not audible as pitch change
+    static constexpr double maxRateAdjustment = 0.005;
+    static constexpr double fillSmoothing = 0.05;
+
+    SpscRing<qint32> m_ring;
+    const std::size_t m_targetFill;
+
+    // audio thread only
+    std::vector<qint32> m_readBuffer;
+
+    // emulation thread only
+    double m_averageFill;
+    double m_rateAdjustment { 1. };
+
+    std::atomic<quint64> m_underruns {};
+    std::atomic<quint64> m_overflows {};
+};
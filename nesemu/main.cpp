@@ -1,8 +1,8 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QFileDialog>
 #include <QMessageBox>
-#include <QByteArray>
-#include <QDataStream>
+#include <QElapsedTimer>
 #include <QImage>
 #include <QFile>
 #include <QTableView>
@@ -11,29 +11,50 @@
 #include <QAudioFormat>
 #include <QAudioDeviceInfo>
 #include <QAudioOutput>
+#include <QSysInfo>
+
+// system includes
+#include <algorithm>
+#include <memory>
 
 // dbcorelib includes
-#include "waverecorder.h"
-#include "fifostream.h"
 #include "utils/datastreamutils.h"
 
 // dbguilib includes
 #include "canvaswidget.h"
 
 // nescorelib includes
+#include "avrecorder.h"
 #include "nesemulator.h"
 #include "emusettings.h"
+#include "runahead.h"
 
 // local includes
+#include "audioringdevice.h"
 #include "memorymodel.h"
 
 int main(int argc, char **argv)
 {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("rom"), QStringLiteral("ROM file (*.nes) to run, asked for when missing."));
+
+    const QCommandLineOption recordVideoOption(QStringLiteral("record-video"),
+                                               QStringLiteral("Record all presented frames as y4m video to <file>."),
+                                               QStringLiteral("file"));
+    const QCommandLineOption recordAudioOption(QStringLiteral("record-audio"),
+                                               QStringLiteral("Record all emulated audio as wave to <file>, empty to disable (default sound.wav)."),
+                                               QStringLiteral("file"), QStringLiteral("sound.wav"));
+    parser.addOption(recordVideoOption);
+    parser.addOption(recordAudioOption);
+
+    parser.process(app);
+
     NesEmulator emulator;
 
-    const QString path = app.arguments().count() > 1 ? app.arguments().at(1) : QFileDialog::getOpenFileName(nullptr, "Select ROM file...", QString(), "ROM file (*.nes)");
+    const QString path = !parser.positionalArguments().isEmpty() ? parser.positionalArguments().first() : QFileDialog::getOpenFileName(nullptr, "Select ROM file...", QString(), "ROM file (*.nes)");
 
     if(path.isEmpty())
         return 0;
@@ -48,68 +69,42 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    // Audio recorder
-    WaveRecorder recorder(1, emulator.apu().sampleRate(), "sound.wav");
-    QObject::connect(&emulator.apu(), &Apu::samplesFinished, &recorder, &WaveRecorder::addSamples);
+    // Recorder, converts and writes on its own thread, the emulator keeps running without
+    std::unique_ptr<AvRecorder> recorder;
+    if(!parser.value(recordVideoOption).isEmpty() || !parser.value(recordAudioOption).isEmpty())
+    {
+        try {
+            recorder = std::make_unique<AvRecorder>(parser.value(recordVideoOption), parser.value(recordAudioOption), emulator.apu().sampleRate());
+        } catch (const std::exception &e) {
+            QMessageBox::warning(nullptr, "Error while starting recording!", QString::fromStdString(e.what()));
+        }
+    }
 
     // Live audio playback
-    FifoStream stream;
-    QObject::connect(&emulator.apu(), &Apu::samplesFinished, [&stream](const QVector<qint32> &samples){
-        QByteArray buf;
-        buf.reserve(samples.size() * sizeof(qint32));
-
-        QDataStream dataStream(&buf, QIODevice::WriteOnly);
-        dataStream.setByteOrder(QDataStream::BigEndian);
-
-        for(auto sample : samples)
-            dataStream << sample;
-
-        Q_ASSERT(buf.size() == samples.size() * sizeof(qint32));
-
-        stream.write(buf);
+    const auto targetFill = std::size_t(emulator.apu().sampleRate()) * EmuSettings::Audio::targetLatency / 1000;
+    AudioRingDevice stream(targetFill * 4, targetFill);
+    QVector<qint32> samples;
+    emulator.setSamplesFinishedCallback([&emulator, &recorder, &stream, &samples](){
+        samples.resize(emulator.apu().samplesAvailable());
+        emulator.apu().readSamples(samples.data(), samples.size());
+
+        if(recorder)
+            recorder->addSamples(samples.constData(), samples.size());
+        stream.pushSamples(samples.constData(), samples.size());
     });
 
     // Display
     CanvasWidget canvas;
     canvas.setWindowTitle(QString("%0 - Mapper: %1").arg(QFileInfo(path).fileName()).arg(rom.mapperNumber));
     canvas.show();
-    quint64 frameCounter {};
-    QObject::connect(&emulator.ppu(), &Ppu::frameFinished, [&canvas, &frameCounter](const std::array<qint32,Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &frame){
+    const auto showFrame = [&canvas, &recorder](const std::array<qint32,Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &frame){
         canvas.setImage(QImage(reinterpret_cast<const uchar*>(&frame[0]), Ppu::SCREEN_WIDTH, Ppu::SCREEN_HEIGHT, QImage::Format_RGB32));
 
-        QFile file(QString("frames/%0.bmp").arg(frameCounter++));
-        if(!file.open(QIODevice::WriteOnly))
-            return;
-
-        constexpr quint32 bitmapSize = Ppu::SCREEN_WIDTH * Ppu::SCREEN_HEIGHT * sizeof(quint32);
-
-        QDataStream dataStream(&file);
-        dataStream.setByteOrder(QDataStream::LittleEndian);
-
-        //BMP Header
-        dataStream << quint16(0x4D42);            //BM-Header
-        dataStream << quint32(54 + bitmapSize);   //File size
-        dataStream << quint32(0);                 //Unused
-        dataStream << quint32(54);                //Offset to bitmap data
-
-        //DIB Header
-        dataStream << quint32(40);                //DIP Header size
-        dataStream << Ppu::SCREEN_WIDTH;          //width
-        dataStream << Ppu::SCREEN_HEIGHT;         //height
-        dataStream << quint16(1);                 //Number of color planes
-        dataStream << quint16(32);                //Bits per pixel
-        dataStream << quint32(0);                 //No compression;
-        dataStream << bitmapSize;                 //Size of bitmap data
-        dataStream << quint32(2835);              //Horizontal print resolution
-        dataStream << quint32(2835);              //Horizontal print resolution
-        dataStream << quint32(0);                 //Number of colors in palette
-        dataStream << quint32(0);                 //Important colors
-
-        dataStream << frame;
-    });
+        if(recorder)
+            recorder->addFrame(frame);
+    };
 
     MemoryModel model(emulator);
-    QObject::connect(&emulator.ppu(), &Ppu::frameFinished, &model, &MemoryModel::refresh);
 
     QTableView tableView;
     {
@@ -125,18 +120,28 @@ int main(int argc, char **argv)
     tableView.setModel(&model);
     tableView.show();
 
+    RunAhead runAhead(emulator, EmuSettings::runAheadFrames);
+
+    // Frames are scheduled against a monotonic clock, an integer timer interval alone would
+    // drift from the target fps further than the rate control can compensate
+    QElapsedTimer clock;
+    double nextFrame {};
     QTimer timer;
-    QObject::connect(&timer, &QTimer::timeout, &emulator, &NesEmulator::emuClockFrame);
-    timer.setInterval(EmuSettings::emuTimeFramePeriod);
+    timer.setTimerType(Qt::PreciseTimer);
+    timer.setSingleShot(true);
+    QObject::connect(&timer, &QTimer::timeout, [&runAhead, &clock, &nextFrame, &timer](){
+        runAhead.emuClockFrame();
+
+        nextFrame += EmuSettings::emuTimeFramePeriod;
+        timer.start(std::max(0, qRound(nextFrame - clock.nsecsElapsed() / 1000000.)));
+    });
 
-    // HACK: overclocking a little bit when audio device reaches near end
-    QObject::connect(&emulator.ppu(), &Ppu::frameFinished, [&stream, &timer](){
-        int speed = EmuSettings::emuTimeFramePeriod;
-        if(stream.bytesAvailable() / sizeof(qint32) < 4096)
-            speed = double(speed) * 0.9;
+    emulator.setFrameFinishedCallback([&showFrame, &model, &emulator, &stream](const std::array<qint32,Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &frame){
+        showFrame(frame);
+        model.refresh();
 
-        if(timer.interval() != speed)
-            timer.setInterval(speed);
+        // follow the clock of the audio device
+        emulator.apu().setSampleRateAdjustment(stream.updateRateAdjustment());
     });
 
     QAudioFormat format;
@@ -144,7 +149,7 @@ int main(int argc, char **argv)
     format.setChannelCount(1);
     format.setSampleSize(sizeof(qint32) * 8);
     format.setCodec("audio/pcm");
-    format.setByteOrder(QAudioFormat::LittleEndian);
+    format.setByteOrder(QAudioFormat::Endian(QSysInfo::ByteOrder)); // samples are pushed as they are
     format.setSampleType(QAudioFormat::SignedInt);
 
     {
@@ -156,9 +161,12 @@ int main(int argc, char **argv)
         }
     }
 
+    stream.open(QIODevice::ReadOnly);
+
     QAudioOutput output(format);
     output.start(&stream);
-    timer.start();
+    clock.start();
+    timer.start(0);
 
     return app.exec();
 }
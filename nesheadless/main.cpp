@@ -0,0 +1,509 @@
+#include <QCoreApplication>
+#include <QByteArray>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QDataStream>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+
+// system includes
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// dbcorelib includes
+#include "utils/datastreamutils.h"
+
+// nescorelib includes
+#include "avrecorder.h"
+#include "nesemulator.h"
+#include "emusettings.h"
+#include "rom.h"
+#include "runahead.h"
+#include "movie.h"
+#include "movieinput.h"
+#include "crc32.h"
+
+namespace {
+bool writeBitmap(const QString &path, const std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &frame)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    constexpr quint32 bitmapSize = Ppu::SCREEN_WIDTH * Ppu::SCREEN_HEIGHT * sizeof(quint32);
+
+    QDataStream dataStream(&file);
+    dataStream.setByteOrder(QDataStream::LittleEndian);
+
+    //BMP Header
+    dataStream << quint16(0x4D42);            //BM-Header
+    dataStream << quint32(54 + bitmapSize);   //File size
+    dataStream << quint32(0);                 //Unused
+    dataStream << quint32(54);                //Offset to bitmap data
+
+    //DIB Header
+    dataStream << quint32(40);                //DIP Header size
+    dataStream << Ppu::SCREEN_WIDTH;          //width
+    dataStream << Ppu::SCREEN_HEIGHT;         //height
+    dataStream << quint16(1);                 //Number of color planes
+    dataStream << quint16(32);                //Bits per pixel
+    dataStream << quint32(0);                 //No compression;
+    dataStream << bitmapSize;                 //Size of bitmap data
+    dataStream << quint32(2835);              //Horizontal print resolution
+    dataStream << quint32(2835);              //Horizontal print resolution
+    dataStream << quint32(0);                 //Number of colors in palette
+    dataStream << quint32(0);                 //Important colors
+
+    dataStream << frame;
+
+    return true;
+}
+
+QString decodeCacheStatus(const Cpu &cpu)
+{
+    if(!cpu.decodeCacheEnabled())
+        return QStringLiteral("off");
+
+    const auto &stats = cpu.decodeCacheStats();
+    const auto lookups = stats.hits + stats.misses;
+    return QStringLiteral("%0 hits, %1 misses (%2% hit rate), %3 invalidations")
+            .arg(stats.hits).arg(stats.misses)
+            .arg(lookups ? 100. * stats.hits / lookups : 0., 0, 'f', 2)
+            .arg(stats.invalidations);
+}
+
+// Most expensive opcodes first, unused ones are left out
+void printOpcodeHistogram(QTextStream &out, const Cpu::OpcodeHistogram &histogram)
+{
+    std::vector<quint8> opcodes;
+    quint64 totalCycles = 0;
+    for(std::size_t opcode = 0; opcode < histogram.size(); opcode++)
+    {
+        if(!histogram[opcode].executions)
+            continue;
+
+        opcodes.push_back(quint8(opcode));
+        totalCycles += histogram[opcode].cycles;
+    }
+
+    std::sort(opcodes.begin(), opcodes.end(), [&histogram](quint8 a, quint8 b){
+        return histogram[a].cycles > histogram[b].cycles;
+    });
+
+    out << "opcode histogram:" << endl
+        << "  op  instruction  addressing  executions      cycles  cycles/exec  cycles%" << endl;
+    for(const auto opcode : opcodes)
+    {
+        const auto &counter = histogram[opcode];
+        out << "  " << QString::number(opcode, 16).rightJustified(2, QLatin1Char('0')).toUpper()
+            << "  " << QString::fromLatin1(Cpu::instructionName(opcode)).leftJustified(11)
+            << "  " << QString::fromLatin1(Cpu::addressingName(opcode)).leftJustified(10)
+            << "  " << QString::number(counter.executions).rightJustified(10)
+            << "  " << QString::number(counter.cycles).rightJustified(10)
+            << "  " << QString::number(double(counter.cycles) / counter.executions, 'f', 2).rightJustified(11)
+            << "  " << QString::number(100. * counter.cycles / totalCycles, 'f', 2).rightJustified(7) << endl;
+    }
+}
+
+bool writeState(const QString &path, const NesEmulator &emulator)
+{
+    QFile file(path);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QByteArray state(int(emulator.stateSize()), Qt::Uninitialized);
+    emulator.saveState(reinterpret_cast<quint8*>(state.data()), state.size());
+
+    return file.write(state) == state.size();
+}
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("nesheadless"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Runs a ROM without display or audio device as fast as possible."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("rom"), QStringLiteral("ROM file (*.nes) to run."));
+
+    const QCommandLineOption framesOption(QStringList { QStringLiteral("f"), QStringLiteral("frames") },
+                                          QStringLiteral("Number of frames to emulate (default 600)."),
+                                          QStringLiteral("count"), QStringLiteral("600"));
+    const QCommandLineOption frameOption(QStringLiteral("dump-frame"),
+                                         QStringLiteral("Write the last framebuffer as bitmap to <file>."),
+                                         QStringLiteral("file"));
+    const QCommandLineOption audioOption(QStringLiteral("dump-audio"),
+                                         QStringLiteral("Record all emulated audio as wave to <file>."),
+                                         QStringLiteral("file"));
+    const QCommandLineOption videoOption(QStringLiteral("dump-video"),
+                                         QStringLiteral("Record all presented frames as y4m video to <file>."),
+                                         QStringLiteral("file"));
+    const QCommandLineOption sampleRateOption(QStringLiteral("sample-rate"),
+                                              QStringLiteral("Apu output rate in Hz, 22050, 44100, 48000 or 96000 (default 44100)."),
+                                              QStringLiteral("rate"), QStringLiteral("44100"));
+    const QCommandLineOption noAudioOption(QStringLiteral("no-audio"),
+                                           QStringLiteral("Skip the sound synthesis, the apu keeps the timing the cpu can see."));
+    const QCommandLineOption stateOption(QStringLiteral("dump-state"),
+                                         QStringLiteral("Write the final savestate to <file>."),
+                                         QStringLiteral("file"));
+    const QCommandLineOption dispatchOption(QStringLiteral("dispatch"),
+                                            QStringLiteral("Cpu interpreter to use, table or fused (default depends on build)."),
+                                            QStringLiteral("kind"));
+    const QCommandLineOption decodeCacheOption(QStringLiteral("decode-cache"),
+                                               QStringLiteral("Cache the decoded opcodes fetched from prg rom."));
+    const QCommandLineOption noCatchUpOption(QStringLiteral("no-ppu-catch-up"),
+                                             QStringLiteral("Clock the ppu on every cpu cycle instead of catching up lazily."));
+    const QCommandLineOption noFastScanlinesOption(QStringLiteral("no-fast-scanlines"),
+                                                   QStringLiteral("Render every scanline dot by dot."));
+    const QCommandLineOption noBoardHookMaskOption(QStringLiteral("no-board-hook-mask"),
+                                                   QStringLiteral("Call every board clock callback, even the ones the board does not implement."));
+    const QCommandLineOption runAheadOption(QStringLiteral("run-ahead"),
+                                            QStringLiteral("Present the frame <count> frames ahead of the emulated one (default 0)."),
+                                            QStringLiteral("count"), QStringLiteral("0"));
+    const QCommandLineOption recordOption(QStringLiteral("record"),
+                                          QStringLiteral("Record the input and a framebuffer checksum of every frame as movie to <file>."),
+                                          QStringLiteral("file"));
+    const QCommandLineOption playOption(QStringLiteral("play"),
+                                        QStringLiteral("Replay the input of the movie <file> (frame count defaults to its length)."),
+                                        QStringLiteral("file"));
+    const QCommandLineOption verifyOption(QStringLiteral("verify"),
+                                          QStringLiteral("Replay the movie <file> and report the first frame that renders differently."),
+                                          QStringLiteral("file"));
+    const QCommandLineOption profileOption(QStringLiteral("profile"),
+                                           QStringLiteral("Write the hot path counters of every frame as csv to <file> (needs NESCORE_PROFILE)."),
+                                           QStringLiteral("file"));
+    const QCommandLineOption opcodeHistogramOption(QStringLiteral("opcode-histogram"),
+                                                   QStringLiteral("Print how often every opcode was executed and how many cycles it took."));
+    parser.addOption(framesOption);
+    parser.addOption(frameOption);
+    parser.addOption(audioOption);
+    parser.addOption(videoOption);
+    parser.addOption(sampleRateOption);
+    parser.addOption(noAudioOption);
+    parser.addOption(stateOption);
+    parser.addOption(dispatchOption);
+    parser.addOption(decodeCacheOption);
+    parser.addOption(noCatchUpOption);
+    parser.addOption(noFastScanlinesOption);
+    parser.addOption(noBoardHookMaskOption);
+    parser.addOption(runAheadOption);
+    parser.addOption(recordOption);
+    parser.addOption(playOption);
+    parser.addOption(verifyOption);
+    parser.addOption(profileOption);
+    parser.addOption(opcodeHistogramOption);
+
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    if(parser.positionalArguments().count() != 1)
+    {
+        err << "exactly one rom file expected" << endl;
+        return 1;
+    }
+
+    bool ok;
+    auto frames = parser.value(framesOption).toULongLong(&ok);
+    if(!ok)
+    {
+        err << "invalid frame count " << parser.value(framesOption) << endl;
+        return 1;
+    }
+
+    const auto runAheadFrames = parser.value(runAheadOption).toInt(&ok);
+    if(!ok || runAheadFrames < 0)
+    {
+        err << "invalid run-ahead frame count " << parser.value(runAheadOption) << endl;
+        return 1;
+    }
+
+    const auto sampleRate = parser.value(sampleRateOption).toInt(&ok);
+    if(!ok || (sampleRate != 22050 && sampleRate != 44100 && sampleRate != 48000 && sampleRate != 96000))
+    {
+        err << "invalid sample rate " << parser.value(sampleRateOption) << endl;
+        return 1;
+    }
+
+    if(parser.isSet(noAudioOption) && parser.isSet(audioOption))
+    {
+        err << "--no-audio and --dump-audio are exclusive" << endl;
+        return 1;
+    }
+
+    NesEmulator emulator;
+    emulator.apu().setSampleRate(sampleRate);
+    emulator.apu().setAudioEnabled(!parser.isSet(noAudioOption));
+    RunAhead runAhead(emulator, runAheadFrames);
+    emulator.setPpuCatchUpEnabled(!parser.isSet(noCatchUpOption));
+    emulator.ppu().setFastScanlinesEnabled(!parser.isSet(noFastScanlinesOption));
+    emulator.memory().setBoardHookMaskEnabled(!parser.isSet(noBoardHookMaskOption));
+
+    Rom rom;
+    try {
+        rom = Rom::fromFile(parser.positionalArguments().first());
+        emulator.load(rom);
+    } catch (const std::exception &e) {
+        err << "Error while loading rom: " << e.what() << endl;
+        return 1;
+    }
+
+    if(parser.isSet(playOption) && parser.isSet(verifyOption))
+    {
+        err << "--play and --verify are exclusive" << endl;
+        return 1;
+    }
+
+    const auto verify = parser.isSet(verifyOption);
+    const auto play = parser.isSet(playOption) || verify;
+    Movie playMovie;
+    if(play)
+    {
+        const auto path = parser.value(verify ? verifyOption : playOption);
+        try {
+            playMovie = Movie::fromFile(path);
+        } catch (const std::exception &e) {
+            err << "Error while loading movie: " << e.what() << endl;
+            return 1;
+        }
+
+        if(playMovie.romCrc != rom.crc32())
+        {
+            err << "movie " << path << " was recorded with another rom" << endl;
+            return 1;
+        }
+        if(verify && !playMovie.hasFrameCrcs)
+        {
+            err << "movie " << path << " has no framebuffer checksums" << endl;
+            return 1;
+        }
+
+        for(auto i = 0; i < 4; i++)
+            emulator.ports().setInput(i, std::make_unique<MovieInput>(playMovie, i));
+
+        if(!parser.isSet(framesOption))
+            frames = playMovie.frames.size();
+    }
+
+    const auto record = parser.isSet(recordOption);
+    Movie recordMovie;
+    recordMovie.romCrc = rom.crc32();
+    recordMovie.hasFrameCrcs = true;
+
+    if(parser.isSet(dispatchOption))
+    {
+        const auto dispatch = parser.value(dispatchOption);
+        if(dispatch == QStringLiteral("table"))
+            emulator.cpu().setDispatch(Cpu::Dispatch::Table);
+        else if(dispatch == QStringLiteral("fused"))
+            emulator.cpu().setDispatch(Cpu::Dispatch::Fused);
+        else
+        {
+            err << "unknown dispatch " << dispatch << endl;
+            return 1;
+        }
+    }
+
+    emulator.cpu().setDecodeCacheEnabled(parser.isSet(decodeCacheOption));
+
+    std::unique_ptr<AvRecorder> recorder;
+    QVector<qint32> samples;
+    if(parser.isSet(audioOption) || parser.isSet(videoOption))
+    {
+        try {
+            recorder = std::make_unique<AvRecorder>(parser.value(videoOption), parser.value(audioOption), emulator.apu().sampleRate());
+        } catch (const std::exception &e) {
+            err << "Error while starting recording: " << e.what() << endl;
+            return 1;
+        }
+
+        emulator.setSamplesFinishedCallback([&emulator, &recorder, &samples](){
+            samples.resize(emulator.apu().samplesAvailable());
+            emulator.apu().readSamples(samples.data(), samples.size());
+            recorder->addSamples(samples.constData(), samples.size());
+        });
+        emulator.setFrameFinishedCallback([&recorder](const AvRecorder::Frame &frame){
+            recorder->addFrame(frame);
+        });
+    }
+
+    const auto profile = parser.isSet(profileOption);
+    QFile profileFile;
+    QTextStream profileStream(&profileFile);
+    if(profile)
+    {
+        if(!Profiler::compiledIn())
+        {
+            err << "nescorelib was built without NESCORE_PROFILE" << endl;
+            return 1;
+        }
+
+        profileFile.setFileName(parser.value(profileOption));
+        if(!profileFile.open(QIODevice::WriteOnly | QIODevice::Text))
+        {
+            err << "cannot open file " << profileFile.fileName() << " because " << profileFile.errorString() << endl;
+            return 1;
+        }
+
+        profileStream << "frame";
+        for(auto scope = 0; scope < ProfileSnapshot::ScopeCount; scope++)
+        {
+            const auto name = ProfileSnapshot::scopeName(ProfileSnapshot::Scope(scope));
+            profileStream << ',' << name << " calls," << name << " ticks";
+        }
+        profileStream << endl;
+    }
+
+    emulator.cpu().setOpcodeHistogramEnabled(parser.isSet(opcodeHistogramOption));
+
+    // of the emulated frame, with run-ahead the screen shows a frame ahead of it
+    quint32 frameCrc {};
+    if(record || verify)
+    {
+        runAhead.setRealFrameCallback([&frameCrc](const std::array<qint32, Ppu::SCREEN_WIDTH*Ppu::SCREEN_HEIGHT> &frame){
+            frameCrc = crc32(frame.data(), frame.size() * sizeof(qint32));
+        });
+    }
+
+    emulator.resetProfile();
+    ProfileSnapshot lastProfile;
+
+    const auto startCycles = emulator.cycles();
+    const auto startInstructions = emulator.cpu().instructions();
+
+    QElapsedTimer timer;
+    timer.start();
+
+    qint64 runAheadOverhead = 0;
+    qint64 firstDivergentFrame = -1;
+    for(quint64 i = 0; i < frames; i++)
+    {
+        Movie::Frame frame;
+        if(play && i < playMovie.frames.size())
+            frame.events = playMovie.frames[i].events;
+
+        if(frame.events & Movie::EventHardReset)
+            emulator.hardReset();
+        if(frame.events & Movie::EventSoftReset)
+            emulator.softReset();
+
+        emulator.ports().update();
+        runAhead.emuClockFrame();
+        runAheadOverhead += runAhead.lastOverheadTime();
+
+        if(profile)
+        {
+            const auto snapshot = emulator.profileSnapshot();
+            const auto frameProfile = snapshot - lastProfile;
+            lastProfile = snapshot;
+
+            profileStream << i;
+            for(const auto &counter : frameProfile.counters)
+                profileStream << ',' << counter.calls << ',' << counter.ticks;
+            profileStream << endl;
+        }
+
+        if(!record && !verify)
+            continue;
+
+        frame.frameCrc = frameCrc;
+
+        if(record)
+        {
+            for(std::size_t j = 0; j < frame.inputs.size(); j++)
+                frame.inputs[j] = emulator.ports().inputData(j);
+            recordMovie.frames.push_back(frame);
+        }
+
+        if(verify && firstDivergentFrame == -1 && i < playMovie.frames.size() && frame.frameCrc != playMovie.frames[i].frameCrc)
+            firstDivergentFrame = i;
+    }
+
+    const auto elapsed = timer.nsecsElapsed();
+    const auto cycles = emulator.cycles() - startCycles;
+    const auto instructions = emulator.cpu().instructions() - startInstructions;
+    const auto seconds = elapsed / 1000000000.;
+
+    QString recording = QStringLiteral("off");
+    bool recordingFailed = false;
+    if(recorder)
+    {
+        recording = QStringLiteral("%0 frames, %1 dropped frames, %2 dropped samples")
+                .arg(recorder->frames()).arg(recorder->droppedFrames()).arg(recorder->droppedSamples());
+
+        // waits for the writer to drain the queue
+        recorder->finish();
+        recordingFailed = recorder->writeFailed();
+        recorder = nullptr;
+
+        if(recordingFailed)
+            err << "could not write the recording" << endl;
+    }
+
+    if(parser.isSet(frameOption) && !writeBitmap(parser.value(frameOption), emulator.ppu().screenPixels()))
+        err << "could not write frame " << parser.value(frameOption) << endl;
+
+    if(parser.isSet(stateOption) && !writeState(parser.value(stateOption), emulator))
+        err << "could not write state " << parser.value(stateOption) << endl;
+
+    if(record)
+    {
+        try {
+            recordMovie.toFile(parser.value(recordOption));
+        } catch (const std::exception &e) {
+            err << "Error while writing movie: " << e.what() << endl;
+        }
+    }
+
+    out << "frames: " << frames << endl
+        << "seconds: " << seconds << endl
+        << "fps: " << (frames / seconds) << " (" << (frames / seconds / EmuSettings::emuTimeTargetFps) << "x realtime)" << endl
+        << "cycles: " << cycles << endl
+        << "cycles/s: " << (cycles / seconds) << endl
+        << "dispatch: " << (emulator.cpu().dispatch() == Cpu::Dispatch::Fused ? "fused" : "table") << endl
+        << "instructions: " << instructions << endl
+        << "instructions/s: " << (instructions / seconds) << endl
+        << "decode cache: " << decodeCacheStatus(emulator.cpu()) << endl
+        << "fast scanlines: " << emulator.ppu().fastScanlines() << endl
+        << "dot scanlines: " << emulator.ppu().dotScanlines() << endl
+        << "run-ahead: " << runAheadFrames << " frames, " << (frames ? runAheadOverhead / 1000. / frames : 0.) << " us/frame overhead" << endl
+        << "recording: " << recording << endl;
+
+    if(profile)
+    {
+        // inclusive, nested scopes are contained in the outer ones
+        out << "profile (calls, ticks/frame, ticks/call):" << endl;
+        for(auto scope = 0; scope < ProfileSnapshot::ScopeCount; scope++)
+        {
+            const auto &counter = lastProfile.counters[scope];
+            out << "  " << ProfileSnapshot::scopeName(ProfileSnapshot::Scope(scope)) << ": " << counter.calls << ", "
+                << (frames ? counter.ticks / frames : 0) << ", "
+                << (counter.calls ? double(counter.ticks) / counter.calls : 0.) << endl;
+        }
+    }
+
+    if(parser.isSet(opcodeHistogramOption))
+        printOpcodeHistogram(out, emulator.cpu().opcodeHistogram());
+
+    if(verify)
+    {
+        if(firstDivergentFrame != -1)
+        {
+            out << "verify: first divergent frame " << firstDivergentFrame << endl;
+            return 2;
+        }
+
+        out << "verify: all " << std::min<quint64>(frames, playMovie.frames.size()) << " frames identical" << endl;
+    }
+
+    if(recordingFailed)
+        return 1;
+
+    return 0;
+}